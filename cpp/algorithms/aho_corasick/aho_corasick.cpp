@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <iostream>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Implementation of the Aho-Corasick multiple pattern matching automaton.
+//
+// The patterns are stored in a trie whose nodes are extended with failure
+// links: the failure link of a node points to the node of the longest
+// proper suffix of its string that is also a prefix of some pattern.
+// Following the failure links whenever a character cannot be matched
+// lets a single pass over the text find every occurrence of every
+// pattern.
+//
+// Once all patterns are added, the automaton is compiled into a dense
+// state-transition table, so that the scan loop takes one table load per
+// byte of text. To keep the table small, bytes are first mapped to
+// equivalence classes: one class per byte used by some pattern, and a
+// shared class for all the other bytes.
+//
+// Time complexity: O(L * C) to build, where L is the total length of
+//      the patterns and C the number of byte classes; O(N + Z) to scan a
+//      text of length N with Z matches.
+//
+// For more information:
+// https://en.wikipedia.org/wiki/Aho%E2%80%93Corasick_algorithm
+//
+// Sample usage:
+//      aho_corasick ac;
+//      ac.insert("he");
+//      ac.insert("she");
+//      ac.build();
+//      ac.match("ushers"); // (1, 1), (0, 2)
+class aho_corasick {
+public:
+    aho_corasick(): nodes(1), built(false) {}
+
+    int insert(const std::string& pattern);
+    void build();
+
+    template <class Callback>
+    void scan(const char* text, size_t length, Callback report) const;
+
+    std::vector<std::pair<int, size_t>> match(const std::string& text) const;
+
+private:
+    struct node {
+        node(): fail(0) {}
+
+        std::unordered_map<unsigned char, int> children;
+        int fail;
+        std::vector<int> patterns;
+    };
+
+    // Trie used while patterns are being added.
+    std::vector<node> nodes;
+    std::vector<size_t> pattern_length;
+
+    // Compiled automaton. Each entry of the table holds the target
+    // state shifted left by one, with the lowest bit set when some
+    // pattern ends at that state or on its failure chain, so that the
+    // scan loop only touches the output arrays on an actual match.
+    // There are up to 257 byte classes, one per byte plus the shared
+    // one, so they do not fit in a byte.
+    bool built;
+    int classes;
+    unsigned short byte_class[256];
+    std::vector<unsigned> table;
+
+    // output_start[s]..output_start[s + 1] delimit the ids of the
+    // patterns ending at state s, and dict[s] is the closest state on the
+    // failure chain of s with patterns of its own (-1 if there is none).
+    std::vector<int> output_start;
+    std::vector<int> output;
+    std::vector<int> dict;
+};
+
+// Adds a pattern to the automaton. Must be called before build().
+//
+// Args:
+//      pattern: non-empty string to search for
+//
+// Returns: the id of the pattern, which is reported with its matches
+int aho_corasick::insert(const std::string& pattern) {
+    int state = 0;
+    for (unsigned char c : pattern) {
+        auto it = nodes[state].children.find(c);
+        if (it == nodes[state].children.end()) {
+            nodes[state].children[c] = nodes.size();
+            state = nodes.size();
+            nodes.push_back(node());
+        } else {
+            state = it->second;
+        }
+    }
+
+    int id = pattern_length.size();
+    nodes[state].patterns.push_back(id);
+    pattern_length.push_back(pattern.size());
+    built = false;
+
+    return id;
+}
+
+// Computes the failure links and compiles the trie into the transition
+// table used by scan().
+void aho_corasick::build() {
+    // Byte class 0 is shared by all the bytes no pattern uses.
+    std::fill(byte_class, byte_class + 256, 0);
+    classes = 1;
+    for (const auto& n : nodes)
+        for (const auto& kv : n.children)
+            if (byte_class[kv.first] == 0)
+                byte_class[kv.first] = classes++;
+
+    const int states = nodes.size();
+    dict.assign(states, -1);
+
+    // Visit the states in breadth-first order, so that the failure link
+    // of a state is always resolved before the state itself.
+    std::queue<int> q;
+    std::vector<int> target(static_cast<size_t>(states) * classes, 0);
+    for (const auto& kv : nodes[0].children) {
+        target[byte_class[kv.first]] = kv.second;
+        q.push(kv.second);
+    }
+
+    while (!q.empty()) {
+        int state = q.front();
+        q.pop();
+
+        int fail = nodes[state].fail;
+        dict[state] = nodes[fail].patterns.empty() ? dict[fail] : fail;
+
+        int* row = &target[static_cast<size_t>(state) * classes];
+        const int* fail_row = &target[static_cast<size_t>(fail) * classes];
+        std::copy(fail_row, fail_row + classes, row);
+
+        for (const auto& kv : nodes[state].children) {
+            int c = byte_class[kv.first];
+            nodes[kv.second].fail = fail_row[c];
+            row[c] = kv.second;
+            q.push(kv.second);
+        }
+    }
+
+    output_start.assign(states + 1, 0);
+    output.clear();
+    for (int state = 0; state < states; ++state) {
+        output_start[state] = output.size();
+        output.insert(output.end(), nodes[state].patterns.begin(),
+                      nodes[state].patterns.end());
+    }
+    output_start[states] = output.size();
+
+    std::vector<bool> reports(states, false);
+    for (int state = 1; state < states; ++state)
+        reports[state] = !nodes[state].patterns.empty() || dict[state] != -1;
+    table.resize(target.size());
+    for (size_t i = 0; i < target.size(); ++i)
+        table[i] = (static_cast<unsigned>(target[i]) << 1) | reports[target[i]];
+
+    built = true;
+}
+
+// Scans text and calls report(pattern_id, position) for every match,
+// where position is the index at which the match starts. Matches are
+// reported in order of their end position.
+//
+// Args:
+//      text: pointer to the text to scan
+//      length: length of the text
+//      report: callback invoked for each match
+template <class Callback>
+void aho_corasick::scan(const char* text, size_t length,
+                        Callback report) const {
+    if (!built)
+        return;
+
+    unsigned entry = 0;
+    for (size_t i = 0; i < length; ++i) {
+        unsigned char c = text[i];
+        entry = table[static_cast<size_t>(entry >> 1) * classes + byte_class[c]];
+        if ((entry & 1) == 0)
+            continue;
+
+        for (int s = entry >> 1; s > 0; s = dict[s])
+            for (int k = output_start[s]; k < output_start[s + 1]; ++k)
+                report(output[k], i + 1 - pattern_length[output[k]]);
+    }
+}
+
+// Returns all (pattern id, position) pairs matched in text.
+std::vector<std::pair<int, size_t>> aho_corasick::match(
+        const std::string& text) const {
+    std::vector<std::pair<int, size_t>> matches;
+    scan(text.data(), text.size(), [&](int id, size_t pos) {
+        matches.push_back(std::make_pair(id, pos));
+    });
+
+    return matches;
+}
+
+// Test code
+int main()
+{
+    aho_corasick ac;
+    ac.insert("he");
+    ac.insert("she");
+    ac.insert("his");
+    ac.insert("hers");
+    ac.build();
+
+    // (1, 1) (0, 2) (3, 2)
+    for (const auto& m : ac.match("ushers"))
+        std::cout << "(" << m.first << ", " << m.second << ") ";
+    std::cout << std::endl;
+
+    // Patterns using every byte value: pattern b is two copies of byte b.
+    aho_corasick bytes;
+    for (int b = 0; b < 256; ++b)
+        bytes.insert(std::string(2, static_cast<char>(b)));
+    bytes.build();
+
+    // (255, 0) (5, 2)
+    for (const auto& m : bytes.match(std::string("\xff\xff\x05\x05", 4)))
+        std::cout << "(" << m.first << ", " << m.second << ") ";
+    std::cout << std::endl;
+
+    return 0;
+}
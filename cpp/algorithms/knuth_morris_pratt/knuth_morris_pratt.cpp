@@ -1,7 +1,22 @@
+#include <algorithm>
+#include <cstring>
 #include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 std::vector<int> prefix(const std::string& str)
 {
     std::vector<int> pi(str.size());
@@ -19,13 +34,17 @@ std::vector<int> prefix(const std::string& str)
     return pi;
 }
 
-std::vector<int> match(const std::string& str, const std::string& pattern)
+// Runs the Knuth-Morris-Pratt automaton over str[begin..] with an empty
+// initial state, appending the starting position of every occurrence of
+// pattern to matches.
+//
+// Args:
+//      pi: prefix function of pattern
+void _match(const std::string& str, const std::string& pattern,
+            const std::vector<int>& pi, size_t begin, std::vector<int>& matches)
 {
-    std::vector<int> matches;
-    auto pi = prefix(pattern);
-
     size_t k = 0;
-    for (size_t i = 0; i < str.size(); ++i) {
+    for (size_t i = begin; i < str.size(); ++i) {
         while (k >= pattern.length() || (k > 0 && str[i] != pattern[k]))
             k = pi[k - 1];
 
@@ -34,10 +53,292 @@ std::vector<int> match(const std::string& str, const std::string& pattern)
         if (k == pattern.size()) 
             matches.push_back(i - pattern.size() + 1);
     }
+}
+
+std::vector<int> match(const std::string& str, const std::string& pattern)
+{
+    std::vector<int> matches;
+    auto pi = prefix(pattern);
+
+    _match(str, pattern, pi, 0, matches);
+
+    return matches;
+}
+
+// Returns the same positions as match(), but first filters candidate
+// positions 16 at a time by comparing the first and last characters of
+// the pattern against two shifted blocks of text with SSE2 (W. Mula's
+// "generic SIMD" substring search). Only the candidates that pass the
+// filter are compared in full.
+//
+// Inputs with many candidates (e.g. highly repetitive text) would make
+// the verification quadratic, so once the verification work outgrows
+// the scanned text, the rest of the text is handed over to the
+// Knuth-Morris-Pratt automaton.
+//
+// Time complexity: O(N + M) in the worst case.
+std::vector<int> match_simd(const std::string& str, const std::string& pattern)
+{
+#ifdef __SSE2__
+    const size_t n = str.size(), m = pattern.size();
+    if (m < 2 || m > n)
+        return match(str, pattern);
+
+    std::vector<int> matches;
+    const char* text = str.data();
+    const char* pat = pattern.data();
+
+    const __m128i first = _mm_set1_epi8(pat[0]);
+    const __m128i last = _mm_set1_epi8(pat[m - 1]);
+
+    size_t verified = 0;
+    size_t i = 0;
+    for (; i + m - 1 + 16 <= n; i += 16) {
+        // Switch to KMP once verification dominates the running time.
+        if (verified > 4 * i + 4096) {
+            _match(str, pattern, prefix(pattern), i, matches);
+            return matches;
+        }
+
+        __m128i block_first = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(text + i));
+        __m128i block_last = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(text + i + m - 1));
+
+        unsigned mask = _mm_movemask_epi8(_mm_and_si128(
+                _mm_cmpeq_epi8(first, block_first),
+                _mm_cmpeq_epi8(last, block_last)));
+
+        while (mask != 0) {
+            size_t pos = i + __builtin_ctz(mask);
+            if (std::memcmp(text + pos + 1, pat + 1, m - 2) == 0)
+                matches.push_back(pos);
+            verified += m;
+            mask &= mask - 1;
+        }
+    }
+
+    for (; i + m <= n; ++i)
+        if (std::memcmp(text + i, pat, m) == 0)
+            matches.push_back(i);
+
+    return matches;
+#else
+    return match(str, pattern);
+#endif
+}
+
+// Resumable Knuth-Morris-Pratt matcher. The text is fed in chunks of
+// arbitrary size, and the automaton state is kept between calls, so
+// occurrences that straddle two chunks are still reported. Memory use
+// does not depend on the length of the text.
+//
+// Sample usage:
+//      kmp_matcher matcher("abc");
+//      matcher.feed("xxab", 4);
+//      matcher.feed("cab", 3); // returns {2}
+class kmp_matcher {
+public:
+    explicit kmp_matcher(const std::string& _pattern)
+        : pattern(_pattern), pi(prefix(_pattern)), k(0), offset(0) {}
+
+    // Forgets all text fed so far.
+    void reset() {
+        k = 0;
+        offset = 0;
+    }
+
+    // Number of characters fed since construction or the last reset.
+    size_t position() const {
+        return offset;
+    }
+
+    // Feeds the next chunk of text and calls report(position) for every
+    // occurrence of the pattern ending inside the chunk, where position
+    // is the index in the whole text at which the occurrence starts.
+    //
+    // Args:
+    //      data: pointer to the chunk
+    //      length: length of the chunk
+    //      report: callback invoked for each match
+    template <class Callback>
+    void feed(const char* data, size_t length, Callback report) {
+        if (pattern.empty()) {
+            offset += length;
+            return;
+        }
+
+        for (size_t i = 0; i < length; ++i) {
+            while (k >= pattern.length() || (k > 0 && data[i] != pattern[k]))
+                k = pi[k - 1];
+
+            if (data[i] == pattern[k])
+                ++k;
+            if (k == pattern.size())
+                report(offset + i + 1 - pattern.size());
+        }
+        offset += length;
+    }
+
+    // Same as above, but returns the positions of the matches.
+    std::vector<size_t> feed(const char* data, size_t length) {
+        std::vector<size_t> matches;
+        feed(data, length, [&](size_t pos) { matches.push_back(pos); });
+
+        return matches;
+    }
+
+private:
+    std::string pattern;
+    std::vector<int> pi;
+    size_t k;
+    size_t offset;
+};
+
+// Counts the occurrences of pattern in str without storing their
+// positions.
+size_t count_matches(const std::string& str, const std::string& pattern)
+{
+    size_t count = 0;
+    kmp_matcher matcher(pattern);
+    matcher.feed(str.data(), str.size(), [&](size_t) { ++count; });
+
+    return count;
+}
+
+// Splits the possible starting positions of a pattern of length m in a
+// text of length n into one contiguous range per thread, and runs
+// scan(chunk, begin, end) on its own thread for each. The text range
+// [begin, end) extends the range of starting positions by m - 1
+// characters, so every occurrence lies entirely inside the range of
+// exactly one chunk.
+template <class Scan>
+void _parallel_chunks(size_t n, size_t m, unsigned threads, Scan scan)
+{
+    if (threads == 0)
+        threads = 1;
+
+    const size_t starts = n - m + 1;
+    const size_t chunk = (starts + threads - 1) / threads;
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t) {
+        size_t begin = std::min(starts, t * chunk);
+        size_t end = std::min(starts, begin + chunk) + m - 1;
+        pool.push_back(std::thread(scan, t, begin, end));
+    }
+
+    for (auto& thread : pool)
+        thread.join();
+}
+
+// Parallel version of match(). Each thread scans its own chunk of the
+// text, the chunks overlapping by pattern.size() - 1 characters, and the
+// per-chunk results are concatenated in order.
+//
+// Args:
+//      str: text to search in
+//      pattern: string to search for
+//      threads: number of threads to use
+std::vector<int> match_parallel(const std::string& str,
+                                const std::string& pattern,
+                                unsigned threads =
+                                    std::thread::hardware_concurrency())
+{
+    if (pattern.empty() || pattern.size() > str.size())
+        return std::vector<int>();
+
+    std::vector<std::vector<int> > partial(std::max(threads, 1u));
+    _parallel_chunks(str.size(), pattern.size(), threads,
+            [&](unsigned t, size_t begin, size_t end) {
+        kmp_matcher matcher(pattern);
+        matcher.feed(str.data() + begin, end - begin, [&](size_t pos) {
+            partial[t].push_back(begin + pos);
+        });
+    });
+
+    std::vector<int> matches;
+    for (const auto& part : partial)
+        matches.insert(matches.end(), part.begin(), part.end());
 
     return matches;
 }
 
+// Parallel version of count_matches().
+size_t count_matches_parallel(const std::string& str,
+                              const std::string& pattern,
+                              unsigned threads =
+                                  std::thread::hardware_concurrency())
+{
+    if (pattern.empty() || pattern.size() > str.size())
+        return 0;
+
+    std::vector<size_t> partial(std::max(threads, 1u));
+    _parallel_chunks(str.size(), pattern.size(), threads,
+            [&](unsigned t, size_t begin, size_t end) {
+        size_t count = 0;
+        kmp_matcher matcher(pattern);
+        matcher.feed(str.data() + begin, end - begin,
+                     [&](size_t) { ++count; });
+        partial[t] = count;
+    });
+
+    size_t count = 0;
+    for (size_t part : partial)
+        count += part;
+
+    return count;
+}
+
+// Searches the file at path for pattern, calling report(position) for
+// every occurrence. The file is memory-mapped one window at a time and
+// fed to a kmp_matcher, so files larger than memory (or the address
+// space) can be scanned in constant memory.
+//
+// Args:
+//      path: file to scan
+//      pattern: string to search for
+//      report: callback invoked with the starting offset of each match;
+//          taken by reference, so that a stateful callable keeps its state
+//          across windows and is updated for the caller
+//
+// Returns: false if the file could not be opened or mapped
+template <class Callback>
+bool match_file(const std::string& path, const std::string& pattern,
+                Callback&& report)
+{
+    const size_t window = size_t(64) << 20;
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+
+    kmp_matcher matcher(pattern);
+    const size_t size = st.st_size;
+    for (size_t begin = 0; begin < size; begin += window) {
+        size_t length = std::min(window, size - begin);
+        void* data = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, begin);
+        if (data == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        madvise(data, length, MADV_SEQUENTIAL);
+
+        matcher.feed(static_cast<const char*>(data), length,
+                     std::ref(report));
+        munmap(data, length);
+    }
+
+    close(fd);
+    return true;
+}
+
 // Test code
 int main()
 {
@@ -55,5 +356,48 @@ int main()
         fout << matches[i] << " ";
     fout << "\n";
 
+    // The checks below compare the other search functions against
+    // match() and print 1 for each agreement.
+    // On repetitive text, match_simd verifies a candidate at every
+    // position and hands the rest of the text over to the automaton.
+    std::string repetitive(100000, 'a'), run(16, 'a');
+    std::cout << (match_simd(str, pattern) == matches) << " "
+              << (match_simd(repetitive, run)
+                      == match(repetitive, run)) << std::endl;  // 1 1
+
+    // Feeding the text in two chunks, split at every position, must find
+    // the same matches, including those that straddle the split.
+    bool chunks_agree = true;
+    for (size_t split = 0; split <= str.size(); ++split) {
+        kmp_matcher matcher(pattern);
+        std::vector<size_t> found = matcher.feed(str.data(), split);
+        std::vector<size_t> rest = matcher.feed(str.data() + split,
+                                                str.size() - split);
+        found.insert(found.end(), rest.begin(), rest.end());
+        chunks_agree &= found.size() == matches.size() &&
+            std::equal(found.begin(), found.end(), matches.begin());
+    }
+
+    std::ifstream file("strmatch.in");
+    std::string contents((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+    std::vector<int> in_file;
+    bool mapped = match_file("strmatch.in", pattern, [&](size_t pos) {
+        in_file.push_back(pos);
+    });
+    std::cout << chunks_agree << " " << mapped << " "
+              << (in_file == match(contents, pattern)) << std::endl; // 1 1 1
+
+    // Chunked parallel search, on the input and on text where matches
+    // overlap every chunk boundary.
+    auto in_run = match(repetitive, run);
+    std::cout << (match_parallel(str, pattern, 4) == matches) << " "
+              << (match_parallel(repetitive, run, 3) == in_run) << " "
+              << (count_matches(str, pattern) == matches.size()) << " "
+              << (count_matches_parallel(str, pattern, 4) == matches.size())
+              << " "
+              << (count_matches_parallel(repetitive, run, 3) == in_run.size())
+              << std::endl;                                     // 1 1 1 1 1
+
     return 0;
 }
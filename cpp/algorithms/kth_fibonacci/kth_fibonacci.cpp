@@ -1,61 +1,71 @@
 #include <algorithm>
+#include <cstdint>
 #include <iostream>
-#include <stdexcept>
-#include <valarray>
+#include <string>
+#include <vector>
 
-template <class T>
+// Fixed-size matrix whose storage lives inline, so that every operation
+// (including exponentiation) can be evaluated at compile time.
+//
+// Sample usage:
+//      constexpr matrix<long long, 2, 2> m = matrix<long long, 2, 2>::ident();
+//      constexpr auto p = m ^ 10;
+template <class T, int Row, int Col>
 class matrix {
 public:
-    explicit matrix(int _row, int _col):
-        row(_row), col(_col), mat(_row * _col) {}
+    constexpr matrix(): mat() {}
 
-    explicit matrix(int _row, int _col, const T& val):
-        row(_row), col(_col), mat(val, _row * _col) {}
+    constexpr T& operator()(int i, int j) {
+        return mat[i * Col + j];
+    }
 
-    T& operator()(int i, int j) {
-        return mat[i * row + j];
+    constexpr const T& operator()(int i, int j) const {
+        return mat[i * Col + j];
     }
 
-    static const matrix ident(int n) {
-        matrix res(n, n);
-        for (int i = 0; i < n; ++i)
+    static constexpr matrix ident() {
+        static_assert(Row == Col, "identity matrix must be square");
+
+        matrix res;
+        for (int i = 0; i < Row; ++i)
             res(i, i) = 1;
 
         return res;
     }
 
-    static const matrix zeros(int n) {
-        return matrix(n, n, 0);
+    static constexpr matrix zeros() {
+        return matrix();
     }
 
-    matrix operator+(const matrix& add) {
-        matrix res(row, col);
-        for (size_t i = 0; i < mat.size(); ++i)
+    constexpr matrix operator+(const matrix& add) const {
+        matrix res;
+        for (int i = 0; i < Row * Col; ++i)
             res.mat[i] = mat[i] + add.mat[i];
 
         return res;
     }
 
-    void operator+=(const matrix& add) {
-        for (size_t i = 0; i < mat.size(); ++i) 
+    constexpr matrix& operator+=(const matrix& add) {
+        for (int i = 0; i < Row * Col; ++i)
             mat[i] += add.mat[i];
+
+        return *this;
     }
 
-    matrix operator*(matrix& mult) {
-        matrix res(row, mult.col);
-        for (int i = 0; i < row; ++i) 
-            for (int k = 0; k < mult.col; ++k) 
-                for (int j = 0; j < col; ++j) {
-                    T aux = (*this)(i, j) * mult(j, k);
-                    res(i, k) += aux;
-                }
+    template <int K>
+    constexpr matrix<T, Row, K> operator*(const matrix<T, Col, K>& mult) const {
+        matrix<T, Row, K> res;
+        for (int i = 0; i < Row; ++i)
+            for (int k = 0; k < K; ++k)
+                for (int j = 0; j < Col; ++j)
+                    res(i, k) += (*this)(i, j) * mult(j, k);
 
         return res;
     }
 
-    matrix operator^(int n) {
-        matrix res(ident(row));
-        matrix base(*this);
+    constexpr matrix operator^(unsigned long long n) const {
+        matrix res = ident();
+        matrix base = *this;
 
         while (n != 0) {
             if (n % 2 == 1)
@@ -67,46 +77,495 @@ public:
         return res;
     }
 
-    matrix& operator^=(int n) {
-        matrix res = (*this) ^ n;
-        std::swap(*this, res);
+    constexpr matrix& operator^=(unsigned long long n) {
+        *this = (*this) ^ n;
 
         return *this;
     }
 
-    void print() {
-        for (int i = 0; i < row; ++i) {
-            for (int j = 0; j < col; ++j)
+    void print() const {
+        for (int i = 0; i < Row; ++i) {
+            for (int j = 0; j < Col; ++j)
                 std::cout << (*this)(i, j) << " ";
             std::cout << std::endl;
         }
     }
 
 private:
-    int row;
-    int col;
-    std::valarray<T> mat;
+    T mat[Row * Col];
+};
+
+typedef matrix<std::uint64_t, 2, 2> fibonacci_matrix;
+
+// Index of the largest Fibonacci number that fits in 64 unsigned bits.
+constexpr int max_fibonacci_index = 93;
+
+// Table holding F(0), F(1), ..., F(max_fibonacci_index), generated
+// during compilation.
+struct fibonacci_table {
+    constexpr fibonacci_table(): value() {
+        value[1] = 1;
+        for (int i = 2; i <= max_fibonacci_index; ++i)
+            value[i] = value[i - 1] + value[i - 2];
+    }
+
+    std::uint64_t value[max_fibonacci_index + 1];
+};
+
+// Table holding Q^(2^i) for i in [0, 64), where Q is the Fibonacci
+// transition matrix [[1, 1], [1, 0]]. Entries past F(93) are reduced
+// modulo 2^64, which keeps products of table entries exact modulo 2^64.
+struct fibonacci_power_table {
+    constexpr fibonacci_power_table(): value() {
+        value[0](0, 0) = 1;
+        value[0](0, 1) = 1;
+        value[0](1, 0) = 1;
+        for (int i = 1; i < 64; ++i)
+            value[i] = value[i - 1] * value[i - 1];
+    }
+
+    fibonacci_matrix value[64];
 };
 
-long long kth_fibonacci(const int k)
+constexpr fibonacci_table fibonacci_values;
+constexpr fibonacci_power_table fibonacci_powers;
+
+// Computes F(k) modulo 2^64 using the fast doubling identities
+//      F(2m) = F(m) * (2 * F(m + 1) - F(m))
+//      F(2m + 1) = F(m)^2 + F(m + 1)^2
+//
+// Time complexity: O(log(k))
+//
+// Args:
+//      k: index of the Fibonacci number to compute
+constexpr std::uint64_t fibonacci_doubling(unsigned long long k)
+{
+    // a = F(m), b = F(m + 1), where m is the prefix of k processed so far
+    std::uint64_t a = 0, b = 1;
+
+    int bit = 63;
+    while (bit >= 0 && ((k >> bit) & 1) == 0)
+        --bit;
+
+    for (; bit >= 0; --bit) {
+        std::uint64_t c = a * (2 * b - a);
+        std::uint64_t d = a * a + b * b;
+
+        if ((k >> bit) & 1) {
+            a = d;
+            b = c + d;
+        } else {
+            a = c;
+            b = d;
+        }
+    }
+
+    return a;
+}
+
+// Returns Q^k modulo 2^64, where Q is the Fibonacci transition matrix,
+// by multiplying together the precomputed powers of two selected by the
+// bits of k.
+//
+// Args:
+//      k: power to which the transition matrix is raised
+constexpr fibonacci_matrix fibonacci_transition(unsigned long long k)
 {
-    matrix<long long> fib_matrix(2, 2);
-    fib_matrix(0, 0) = 1;
-    fib_matrix(0, 1) = 1;
-    fib_matrix(1, 0) = 1;
-    fib_matrix(1, 1) = 0;
+    fibonacci_matrix res = fibonacci_matrix::ident();
+    for (int bit = 0; k != 0; ++bit, k /= 2)
+        if (k % 2 == 1)
+            res = res * fibonacci_powers.value[bit];
 
-    fib_matrix ^= k;
+    return res;
+}
 
-    return fib_matrix(0, 1);
+// Returns the k-th Fibonacci number. Indices up to max_fibonacci_index
+// are served from the compile-time table; larger indices wrap around
+// modulo 2^64. Negative indices yield 0.
+//
+// Args:
+//      k: index of the Fibonacci number to compute (F(0) = 0, F(1) = 1)
+constexpr std::uint64_t kth_fibonacci(const int k)
+{
+    return k < 0 ? 0
+        : k <= max_fibonacci_index ? fibonacci_values.value[k]
+        : fibonacci_doubling(k);
+}
+
+// Arbitrary-precision non-negative integer. Digits are stored as
+// little-endian limbs in base 10^9, so conversion to a decimal string
+// is linear in the number of digits.
+//
+// Multiplication picks an algorithm based on the operand sizes:
+//      * schoolbook, O(N * M), for small operands
+//      * Karatsuba, O(N^1.58), for medium operands
+//      * number theoretic transform over three primes combined with
+//        the Chinese remainder theorem, O(N * log(N)), for large ones
+class big_integer {
+public:
+    typedef std::vector<std::uint32_t> limbs;
+
+    static const std::uint32_t base = 1000000000;
+    static const int base_digits = 9;
+
+    big_integer() {}
+    big_integer(std::uint64_t value) {
+        while (value != 0) {
+            digits.push_back(value % base);
+            value /= base;
+        }
+    }
+
+    big_integer operator+(const big_integer& rhs) const {
+        big_integer res;
+        res.digits = add(digits, rhs.digits);
+        return res;
+    }
+
+    // Requires *this >= rhs.
+    big_integer operator-(const big_integer& rhs) const {
+        big_integer res;
+        res.digits = subtract(digits, rhs.digits);
+        return res;
+    }
+
+    big_integer operator*(const big_integer& rhs) const {
+        big_integer res;
+        res.digits = multiply(digits, rhs.digits);
+        return res;
+    }
+
+    std::string to_string() const {
+        if (digits.empty())
+            return "0";
+
+        std::string res = std::to_string(digits.back());
+        for (size_t i = digits.size() - 1; i-- > 0; ) {
+            std::string limb = std::to_string(digits[i]);
+            res.append(base_digits - limb.size(), '0');
+            res += limb;
+        }
+
+        return res;
+    }
+
+    // Multiplies two limb vectors by dispatching on their sizes.
+    static limbs multiply(const limbs& a, const limbs& b) {
+        if (a.empty() || b.empty())
+            return limbs();
+
+        size_t small = std::min(a.size(), b.size());
+        if (small < karatsuba_threshold)
+            return multiply_schoolbook(a, b);
+        if (small < ntt_threshold)
+            return multiply_karatsuba(a, b);
+        return multiply_ntt(a, b);
+    }
+
+    static limbs multiply_schoolbook(const limbs& a, const limbs& b);
+    static limbs multiply_karatsuba(const limbs& a, const limbs& b);
+    static limbs multiply_ntt(const limbs& a, const limbs& b);
+
+private:
+    static const size_t karatsuba_threshold = 48;
+    static const size_t ntt_threshold = 1024;
+    // Longest transform supported by all three NTT primes: 2^23 is the
+    // largest power of two dividing 998244353 - 1.
+    static const size_t max_ntt_length = size_t(1) << 23;
+
+    static limbs add(const limbs& a, const limbs& b);
+    static limbs subtract(const limbs& a, const limbs& b);
+    static void trim(limbs& a) {
+        while (!a.empty() && a.back() == 0)
+            a.pop_back();
+    }
+
+    limbs digits;
+};
+
+big_integer::limbs big_integer::add(const limbs& a, const limbs& b) {
+    const limbs& longer = a.size() >= b.size() ? a : b;
+    const limbs& shorter = a.size() >= b.size() ? b : a;
+
+    limbs res(longer.size() + 1);
+    std::uint32_t carry = 0;
+    for (size_t i = 0; i < longer.size(); ++i) {
+        std::uint32_t cur = longer[i] + carry;
+        if (i < shorter.size())
+            cur += shorter[i];
+        carry = cur >= base;
+        res[i] = carry ? cur - base : cur;
+    }
+    res[longer.size()] = carry;
+
+    trim(res);
+    return res;
+}
+
+big_integer::limbs big_integer::subtract(const limbs& a, const limbs& b) {
+    limbs res(a);
+    std::uint32_t borrow = 0;
+    for (size_t i = 0; i < res.size() && (i < b.size() || borrow); ++i) {
+        std::uint32_t sub = borrow + (i < b.size() ? b[i] : 0);
+        borrow = res[i] < sub;
+        res[i] = borrow ? res[i] + base - sub : res[i] - sub;
+    }
+
+    trim(res);
+    return res;
+}
+
+big_integer::limbs big_integer::multiply_schoolbook(const limbs& a,
+                                                    const limbs& b) {
+    if (a.empty() || b.empty())
+        return limbs();
+
+    limbs res(a.size() + b.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        std::uint64_t carry = 0;
+        for (size_t j = 0; j < b.size(); ++j) {
+            std::uint64_t cur = res[i + j] + carry +
+                static_cast<std::uint64_t>(a[i]) * b[j];
+            res[i + j] = cur % base;
+            carry = cur / base;
+        }
+        for (size_t k = i + b.size(); carry != 0; ++k) {
+            std::uint64_t cur = res[k] + carry;
+            res[k] = cur % base;
+            carry = cur / base;
+        }
+    }
+
+    trim(res);
+    return res;
+}
+
+big_integer::limbs big_integer::multiply_karatsuba(const limbs& a,
+                                                   const limbs& b) {
+    if (std::min(a.size(), b.size()) < karatsuba_threshold)
+        return multiply_schoolbook(a, b);
+
+    // Split both operands at m limbs: x = x1 * base^m + x0.
+    size_t m = std::max(a.size(), b.size()) / 2;
+    limbs a0(a.begin(), a.begin() + std::min(m, a.size()));
+    limbs a1(a.begin() + std::min(m, a.size()), a.end());
+    limbs b0(b.begin(), b.begin() + std::min(m, b.size()));
+    limbs b1(b.begin() + std::min(m, b.size()), b.end());
+    trim(a0);
+    trim(b0);
+
+    // z1 = (a0 + a1) * (b0 + b1) - z0 - z2 = a0 * b1 + a1 * b0
+    // The halves go back through multiply, so that halves of a product
+    // too long for multiply_ntt are themselves multiplied with it.
+    limbs z0 = multiply(a0, b0);
+    limbs z2 = multiply(a1, b1);
+    limbs z1 = multiply(add(a0, a1), add(b0, b1));
+    z1 = subtract(subtract(z1, z0), z2);
+
+    limbs res(a.size() + b.size() + 1);
+    const limbs* parts[] = { &z0, &z1, &z2 };
+    for (int p = 0; p < 3; ++p) {
+        std::uint32_t carry = 0;
+        size_t k = p * m;
+        for (size_t i = 0; i < parts[p]->size() || carry; ++i, ++k) {
+            std::uint32_t cur = res[k] + carry;
+            if (i < parts[p]->size())
+                cur += (*parts[p])[i];
+            carry = cur >= base;
+            res[k] = carry ? cur - base : cur;
+        }
+    }
+
+    trim(res);
+    return res;
+}
+
+// Computes (b^e) mod m.
+static std::uint32_t power_mod(std::uint64_t b, std::uint64_t e,
+                               std::uint32_t m)
+{
+    std::uint64_t res = 1;
+    b %= m;
+    while (e != 0) {
+        if (e % 2 == 1)
+            res = res * b % m;
+        b = b * b % m;
+        e /= 2;
+    }
+
+    return res;
+}
+
+// In-place number theoretic transform modulo the prime mod, for which 3
+// is a primitive root. The size of a must be a power of two dividing
+// mod - 1.
+static void ntt(std::vector<std::uint32_t>& a, std::uint32_t mod, bool invert)
+{
+    size_t n = a.size();
+
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j)
+            std::swap(a[i], a[j]);
+    }
+
+    std::vector<std::uint32_t> roots(n / 2);
+    for (size_t len = 2; len <= n; len *= 2) {
+        std::uint64_t w = power_mod(3, (mod - 1) / len, mod);
+        if (invert)
+            w = power_mod(w, mod - 2, mod);
+
+        size_t half = len / 2;
+        roots[0] = 1;
+        for (size_t j = 1; j < half; ++j)
+            roots[j] = roots[j - 1] * w % mod;
+
+        for (size_t i = 0; i < n; i += len)
+            for (size_t j = 0; j < half; ++j) {
+                std::uint32_t u = a[i + j];
+                std::uint32_t v = static_cast<std::uint64_t>(a[i + j + half]) *
+                    roots[j] % mod;
+                a[i + j] = u + v < mod ? u + v : u + v - mod;
+                a[i + j + half] = u >= v ? u - v : u + mod - v;
+            }
+    }
+
+    if (invert) {
+        std::uint64_t n_inv = power_mod(n, mod - 2, mod);
+        for (size_t i = 0; i < n; ++i)
+            a[i] = a[i] * n_inv % mod;
+    }
+}
+
+big_integer::limbs big_integer::multiply_ntt(const limbs& a, const limbs& b) {
+    // Each coefficient of the product is below N * base^2 < 2^83 for
+    // N <= 2^23, which is recovered exactly from its residues modulo
+    // three primes, whose product exceeds 2^86.
+    static const std::uint32_t mods[] = { 998244353, 167772161, 469762049 };
+
+    size_t n = 1;
+    while (n < a.size() + b.size())
+        n *= 2;
+
+    // Longer products would need roots of unity the primes do not have;
+    // a Karatsuba step splits them into halves short enough.
+    if (n > max_ntt_length)
+        return multiply_karatsuba(a, b);
+
+    bool square = &a == &b;
+    std::vector<std::uint32_t> residues[3];
+    for (int p = 0; p < 3; ++p) {
+        std::vector<std::uint32_t> fa(n), fb;
+        for (size_t i = 0; i < a.size(); ++i)
+            fa[i] = a[i] % mods[p];
+        ntt(fa, mods[p], false);
+
+        if (!square) {
+            fb.assign(n, 0);
+            for (size_t i = 0; i < b.size(); ++i)
+                fb[i] = b[i] % mods[p];
+            ntt(fb, mods[p], false);
+        }
+
+        const std::vector<std::uint32_t>& gb = square ? fa : fb;
+        for (size_t i = 0; i < n; ++i)
+            fa[i] = static_cast<std::uint64_t>(fa[i]) * gb[i] % mods[p];
+        ntt(fa, mods[p], true);
+        residues[p].swap(fa);
+    }
+
+    // Garner's algorithm: x = r0 + m0 * (t1 + m1 * t2).
+    const std::uint64_t m0 = mods[0], m1 = mods[1], m2 = mods[2];
+    const std::uint64_t inv_m0_m1 = power_mod(m0, m1 - 2, m1);
+    const std::uint64_t inv_m0m1_m2 = power_mod(m0 * m1 % m2, m2 - 2, m2);
+
+    // x can exceed 64 bits, so the m0 * m1 * t2 term is split as
+    // (high * base + low) * t2, and the high part goes straight into the
+    // carry; every intermediate value then stays below 2^60.
+    const std::uint64_t m0m1_high = m0 * m1 / base, m0m1_low = m0 * m1 % base;
+
+    limbs res(a.size() + b.size());
+    std::uint64_t carry = 0;
+    for (size_t i = 0; i < res.size(); ++i) {
+        std::uint64_t r0 = residues[0][i];
+        std::uint64_t t1 = (residues[1][i] + m1 - r0 % m1) % m1 * inv_m0_m1 % m1;
+        std::uint64_t partial = (r0 + m0 * t1) % m2;
+        std::uint64_t t2 = (residues[2][i] + m2 - partial) % m2 * inv_m0m1_m2 % m2;
+
+        std::uint64_t low = carry % base + r0 + m0 * t1 + m0m1_low * t2;
+        res[i] = low % base;
+        carry = carry / base + low / base + m0m1_high * t2;
+    }
+
+    trim(res);
+    return res;
+}
+
+// Returns the exact decimal representation of the k-th Fibonacci
+// number, using fast doubling over big_integer.
+//
+// Time complexity: O(M(k)), where M(k) is the cost of multiplying two
+// numbers of O(k) digits.
+//
+// Args:
+//      k: index of the Fibonacci number to compute (F(0) = 0, F(1) = 1)
+std::string kth_fibonacci_exact(const int k)
+{
+    if (k < 0)
+        return "0";
+    if (k <= max_fibonacci_index)
+        return std::to_string(fibonacci_values.value[k]);
+
+    // a = F(m), b = F(m + 1), where m is the prefix of k processed so far
+    big_integer a(0), b(1);
+
+    int bit = 31;
+    while ((k >> bit) == 0)
+        --bit;
+
+    for (; bit >= 0; --bit) {
+        bool set = (k >> bit) & 1;
+        big_integer aa = a * a;
+        big_integer bb = b * b;
+
+        // On the last step only F(k) is needed.
+        if (bit == 0 && set)
+            return (aa + bb).to_string();
+
+        big_integer c = a * (b + b - a);
+        if (bit == 0)
+            return c.to_string();
+
+        if (set) {
+            a = aa + bb;
+            b = c + a;
+        } else {
+            a = c;
+            b = aa + bb;
+        }
+    }
+
+    return a.to_string();
 }
 
 // Test code
 int main()
 {
+    static_assert(kth_fibonacci(20) == 6765, "F(20)");
+    static_assert(kth_fibonacci(93) == 12200160415121876738ull, "F(93)");
+    static_assert(kth_fibonacci(-1) == 0, "F(-1)");
+    static_assert(fibonacci_doubling(93) == fibonacci_values.value[93], "F(93)");
+    static_assert(fibonacci_transition(50)(0, 1) == fibonacci_values.value[50],
+                  "Q^50");
+
     std::cout << kth_fibonacci(20) << "\n"; // 6765
     std::cout << kth_fibonacci(13) << "\n"; // 233
-    std::cout << kth_fibonacci(60) << "\n"; // 102334155
+    std::cout << kth_fibonacci(60) << "\n"; // 1548008755920
+    std::cout << kth_fibonacci_exact(100) << "\n";
+        // 354224848179261915075
 
     return 0;
 }
@@ -1,7 +1,229 @@
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
 #include <vector>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// Default memory budget, in bytes, for the full dynamic programming table
+// used by longest_common_substring. Larger inputs fall back to the
+// linear-space Hirschberg algorithm.
+const size_t lcs_default_memory_budget = size_t(256) << 20;
+
+// Computes, in place, the last row of the longest common substring table
+// between A[a_begin..a_end) and B[b_begin..b_end), i.e. row[j] becomes
+// the answer for A[a_begin..a_end) and B[b_begin..b_begin + j).
+//
+// Args:
+//      row: buffer of at least b_end - b_begin + 1 elements
+template <class Iterable>
+void _lcs_forward_row(const Iterable& A, int a_begin, int a_end,
+                      const Iterable& B, int b_begin, int b_end, int* row)
+{
+    int n = b_end - b_begin;
+    std::fill(row, row + n + 1, 0);
+
+    for (int i = a_begin; i < a_end; ++i) {
+        // diag holds the value of row[j - 1] from the previous row
+        int diag = 0;
+        for (int j = 1; j <= n; ++j) {
+            int up = row[j];
+            if (A[i] == B[b_begin + j - 1])
+                row[j] = diag + 1;
+            else
+                row[j] = std::max(up, row[j - 1]);
+            diag = up;
+        }
+    }
+}
+
+// Same as _lcs_forward_row, but over suffixes: row[j] becomes the answer
+// for A[a_begin..a_end) and B[b_begin + j..b_end).
+template <class Iterable>
+void _lcs_backward_row(const Iterable& A, int a_begin, int a_end,
+                       const Iterable& B, int b_begin, int b_end, int* row)
+{
+    int n = b_end - b_begin;
+    std::fill(row, row + n + 1, 0);
+
+    for (int i = a_end - 1; i >= a_begin; --i) {
+        int diag = 0;
+        for (int j = n - 1; j >= 0; --j) {
+            int down = row[j];
+            if (A[i] == B[b_begin + j])
+                row[j] = diag + 1;
+            else
+                row[j] = std::max(down, row[j + 1]);
+            diag = down;
+        }
+    }
+}
+
+// Hirschberg's divide and conquer step: splits A in half, finds the
+// column where an optimal path crosses the middle row and recurses on
+// the two resulting subproblems. Matched elements are appended to result
+// in order.
+//
+// Args:
+//      forward, backward: scratch rows of at least B.size() + 1 elements
+template <class Iterable>
+void _hirschberg(const Iterable& A, int a_begin, int a_end,
+                 const Iterable& B, int b_begin, int b_end,
+                 int* forward, int* backward, Iterable& result)
+{
+    if (a_begin == a_end || b_begin == b_end)
+        return;
+
+    if (a_end - a_begin == 1) {
+        for (int j = b_begin; j < b_end; ++j)
+            if (A[a_begin] == B[j]) {
+                result.push_back(A[a_begin]);
+                break;
+            }
+        return;
+    }
+
+    int mid = a_begin + (a_end - a_begin) / 2;
+    _lcs_forward_row(A, a_begin, mid, B, b_begin, b_end, forward);
+    _lcs_backward_row(A, mid, a_end, B, b_begin, b_end, backward);
+
+    int split = 0, best = -1;
+    for (int j = 0; j <= b_end - b_begin; ++j)
+        if (forward[j] + backward[j] > best) {
+            best = forward[j] + backward[j];
+            split = j;
+        }
+
+    _hirschberg(A, a_begin, mid, B, b_begin, b_begin + split,
+                forward, backward, result);
+    _hirschberg(A, mid, a_end, B, b_begin + split, b_end,
+                forward, backward, result);
+}
+
+// Parallel version of _hirschberg, using up to threads threads. The
+// forward and backward rows of a step are computed concurrently, and the
+// two subproblems, which cover disjoint parts of A and B, are solved
+// concurrently with half of the threads each. The right subproblem gets
+// its own scratch rows and result, which is appended once both are done.
+template <class Iterable>
+void _hirschberg_parallel(const Iterable& A, int a_begin, int a_end,
+                          const Iterable& B, int b_begin, int b_end,
+                          int* forward, int* backward, Iterable& result,
+                          unsigned threads)
+{
+    if (threads <= 1 || a_end - a_begin <= 1 || b_begin == b_end) {
+        _hirschberg(A, a_begin, a_end, B, b_begin, b_end,
+                    forward, backward, result);
+        return;
+    }
+
+    int mid = a_begin + (a_end - a_begin) / 2;
+    std::thread backward_pass([&]() {
+        _lcs_backward_row(A, mid, a_end, B, b_begin, b_end, backward);
+    });
+    _lcs_forward_row(A, a_begin, mid, B, b_begin, b_end, forward);
+    backward_pass.join();
+
+    int split = 0, best = -1;
+    for (int j = 0; j <= b_end - b_begin; ++j)
+        if (forward[j] + backward[j] > best) {
+            best = forward[j] + backward[j];
+            split = j;
+        }
+
+    std::vector<int> right_rows(2 * (b_end - b_begin - split + 1));
+    Iterable right_result;
+    std::thread right([&]() {
+        _hirschberg_parallel(A, mid, a_end, B, b_begin + split, b_end,
+                             right_rows.data(),
+                             right_rows.data() + right_rows.size() / 2,
+                             right_result, threads - threads / 2);
+    });
+    _hirschberg_parallel(A, a_begin, mid, B, b_begin, b_begin + split,
+                         forward, backward, result, threads / 2);
+    right.join();
+
+    result.insert(result.end(), right_result.begin(), right_result.end());
+}
+
+// Linear-space variant of longest_common_substring based on Hirschberg's
+// algorithm. Returns a sequence of the same length as the table-based
+// version, using two rows of B.size() + 1 integers as working memory.
+//
+// Time complexity: O(N * M)
+// Space complexity: O(N + M)
+template <class Iterable>
+Iterable longest_common_substring_hirschberg(const Iterable& A,
+                                             const Iterable& B)
+{
+    std::vector<int> rows(2 * (B.size() + 1));
+
+    Iterable result;
+    _hirschberg(A, 0, A.size(), B, 0, B.size(),
+                rows.data(), rows.data() + B.size() + 1, result);
+
+    return result;
+}
+
+// Fills the cells best[i][j] with i in [i_begin, i_end) and j in
+// [j_begin, j_end) of the row-major table best, whose rows hold
+// stride elements. Cells above and to the left of the block must
+// already be computed.
+template <class Iterable>
+void _lcs_fill_block(const Iterable& A, const Iterable& B, int* best,
+                     size_t stride, size_t i_begin, size_t i_end,
+                     size_t j_begin, size_t j_end)
+{
+    for (size_t i = i_begin; i < i_end; ++i) {
+        int* row = best + i * stride;
+        const int* prev = row - stride;
+        for (size_t j = j_begin; j < j_end; ++j) {
+            if (A[i - 1] == B[j - 1]) {
+                row[j] = prev[j - 1] + 1;
+            } else {
+                row[j] = std::max(prev[j], row[j - 1]);
+            }
+        }
+    }
+}
+
+// Walks back from best[N][M] and returns the sequence encoded by the
+// table.
+template <class Iterable>
+Iterable _lcs_backtrack(const Iterable& A, const Iterable& B,
+                        const std::vector<int>& best)
+{
+    const size_t stride = B.size() + 1;
+
+    Iterable result;
+
+    size_t i = A.size(), j = B.size();
+    while (i != 0 && j != 0) {
+        if (A[i - 1] == B[j - 1]) {
+            result.push_back(A[i - 1]);
+            --i, --j;
+        } else if (best[(i - 1) * stride + j] > best[i * stride + j - 1]) {
+            --i;
+        } else {
+            --j;
+        }
+    }
+
+    std::reverse(result.begin(), result.end());
+
+    return result;
+}
 
 // Implementation of the longest common substring dynamic programming 
 // algorithm.
@@ -12,48 +234,393 @@
 // Example: the longest common substring of the strings "ABABC" and "BABCA" is
 // "ABC".
 // 
+// Note: the elements of the result need not be contiguous in A and B, i.e.
+// this is the longest common subsequence. For the longest contiguous
+// common substring, see suffix_array.cpp.
+//
 // Time complexity: O(N * M), where N and M are the lengths of the two strings.
+//
+// Args:
+//      A, B: sequences to compare
+//      memory_budget: maximum size, in bytes, of the full table; when
+//          exceeded, longest_common_substring_hirschberg is used instead
 template <class Iterable>
 Iterable longest_common_substring(const Iterable& A,
-                                  const Iterable& B)
+                                  const Iterable& B,
+                                  size_t memory_budget =
+                                      lcs_default_memory_budget)
 {
+    const size_t N = A.size(), M = B.size();
+    if ((N + 1) * (M + 1) > memory_budget / sizeof(int))
+        return longest_common_substring_hirschberg(A, B);
+
     // best[i][j] - length of the longest common substring between
-    //      A[0..i] and B[0..j]
+    //      A[0..i] and B[0..j], stored row-major in a flat buffer
     // 
     // best[i][j] is computed as follows:
     //      best[i][j] = best[i - 1][j - 1] + 1, if A[i - 1] == B[j - 1]
     //          (we can extend the longest substring by 1)
     //      best[i][j] = max(best[i - 1][j], best[i][j - 1]) otherwise
     // 
-    std::vector<std::vector<int> > best(A.size() + 1, 
-            std::vector<int>(B.size() + 1));
+    const size_t stride = M + 1;
+    std::vector<int> best((N + 1) * stride);
+    _lcs_fill_block(A, B, best.data(), stride, 1, N + 1, 1, M + 1);
 
-    for (int i = 1; i <= A.size(); ++i)
-        for (int j = 1; j <= B.size(); ++j) {
-            if (A[i - 1] == B[j - 1]) {
-                best[i][j] = best[i - 1][j - 1] + 1;
-            } else {
-                best[i][j] = std::max(best[i - 1][j], best[i][j - 1]);
+    return _lcs_backtrack(A, B, best);
+}
+
+// Parallel version of longest_common_substring. The table is split into
+// tile x tile blocks, which are handed out to the worker threads in
+// anti-diagonal order; a block is computed once the blocks above and to
+// its left are done. The resulting table, and hence the returned
+// sequence, is identical to the sequential one.
+//
+// As with longest_common_substring, a table larger than memory_budget is
+// not built; the linear-space Hirschberg algorithm then runs in parallel
+// instead, which returns a sequence of the same length.
+//
+// Time complexity: O(N * M / threads), for N and M much larger than tile
+// Space complexity: O(N * M), or O((N + M) * threads) above the budget
+//
+// Args:
+//      A, B: sequences to compare
+//      threads: number of worker threads
+//      tile: side of a block, chosen so that a block fits in cache; must
+//          be positive
+//      memory_budget: maximum size, in bytes, of the full table
+template <class Iterable>
+Iterable longest_common_substring_parallel(const Iterable& A,
+                                           const Iterable& B,
+                                           unsigned threads =
+                                               std::thread::hardware_concurrency(),
+                                           size_t tile = 256,
+                                           size_t memory_budget =
+                                               lcs_default_memory_budget)
+{
+    if (tile == 0)
+        throw std::invalid_argument("longest_common_substring_parallel: "
+                                    "tile must be positive");
+
+    const size_t N = A.size(), M = B.size();
+    if ((N + 1) * (M + 1) > memory_budget / sizeof(int)) {
+        std::vector<int> rows(2 * (M + 1));
+
+        Iterable result;
+        _hirschberg_parallel(A, 0, N, B, 0, M, rows.data(),
+                             rows.data() + M + 1, result,
+                             std::max(threads, 1u));
+        return result;
+    }
+
+    const size_t stride = M + 1;
+    std::vector<int> best((N + 1) * stride);
+
+    const size_t tile_rows = (N + tile - 1) / tile;
+    const size_t tile_cols = (M + tile - 1) / tile;
+
+    // Tiles listed diagonal by diagonal, so that every tile comes after
+    // the tiles it depends on.
+    std::vector<std::pair<size_t, size_t> > order;
+    order.reserve(tile_rows * tile_cols);
+    for (size_t d = 0; d + 1 < tile_rows + tile_cols; ++d)
+        for (size_t r = d < tile_cols ? 0 : d - tile_cols + 1;
+             r < tile_rows && r <= d; ++r)
+            order.push_back(std::make_pair(r, d - r));
+
+    std::unique_ptr<std::atomic<bool>[]> done(
+            new std::atomic<bool>[tile_rows * tile_cols]);
+    for (size_t t = 0; t < tile_rows * tile_cols; ++t)
+        done[t].store(false, std::memory_order_relaxed);
+
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (;;) {
+            size_t t = next.fetch_add(1);
+            if (t >= order.size())
+                return;
+
+            size_t r = order[t].first, c = order[t].second;
+            while (r > 0 && !done[(r - 1) * tile_cols + c].load(
+                        std::memory_order_acquire))
+                std::this_thread::yield();
+            while (c > 0 && !done[r * tile_cols + c - 1].load(
+                        std::memory_order_acquire))
+                std::this_thread::yield();
+
+            _lcs_fill_block(A, B, best.data(), stride,
+                            1 + r * tile, 1 + std::min(N, (r + 1) * tile),
+                            1 + c * tile, 1 + std::min(M, (c + 1) * tile));
+            done[r * tile_cols + c].store(true, std::memory_order_release);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t)
+        pool.push_back(std::thread(worker));
+    worker();
+    for (auto& thread : pool)
+        thread.join();
+
+    return _lcs_backtrack(A, B, best);
+}
+
+// Vector types used by lcs_bit_matcher::length_batch to compare A
+// against several sequences at once, one per 64-bit lane. Lanes carry
+// independent bit vectors, so the carries of the bit-parallel update
+// never cross lanes. Besides the arithmetic, each type gathers
+// word w of the match mask of each lane from separate rows.
+#ifdef __SSE2__
+struct _lcs_sse2_lanes {
+    typedef __m128i reg;
+    static const int width = 2;
+
+    static reg zero() { return _mm_setzero_si128(); }
+    static reg load(const std::uint64_t* p) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    }
+    static void store(std::uint64_t* p, reg a) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), a);
+    }
+    static reg gather(const std::uint64_t* const* rows, size_t w) {
+        return _mm_set_epi64x(rows[1][w], rows[0][w]);
+    }
+    static reg add(reg a, reg b) { return _mm_add_epi64(a, b); }
+    static reg bit_and(reg a, reg b) { return _mm_and_si128(a, b); }
+    static reg bit_or(reg a, reg b) { return _mm_or_si128(a, b); }
+    // Returns ~a & b.
+    static reg and_not(reg a, reg b) { return _mm_andnot_si128(a, b); }
+    static reg top_bit(reg a) { return _mm_srli_epi64(a, 63); }
+};
+#endif
+
+#ifdef __AVX2__
+struct _lcs_avx2_lanes {
+    typedef __m256i reg;
+    static const int width = 4;
+
+    static reg zero() { return _mm256_setzero_si256(); }
+    static reg load(const std::uint64_t* p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+    static void store(std::uint64_t* p, reg a) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), a);
+    }
+    static reg gather(const std::uint64_t* const* rows, size_t w) {
+        return _mm256_set_epi64x(rows[3][w], rows[2][w], rows[1][w],
+                                 rows[0][w]);
+    }
+    static reg add(reg a, reg b) { return _mm256_add_epi64(a, b); }
+    static reg bit_and(reg a, reg b) { return _mm256_and_si256(a, b); }
+    static reg bit_or(reg a, reg b) { return _mm256_or_si256(a, b); }
+    static reg and_not(reg a, reg b) { return _mm256_andnot_si256(a, b); }
+    static reg top_bit(reg a) { return _mm256_srli_epi64(a, 63); }
+};
+#endif
+
+#if defined(__AVX2__)
+typedef _lcs_avx2_lanes _lcs_simd_lanes;
+#define LCS_HAVE_SIMD_LANES
+#elif defined(__SSE2__)
+typedef _lcs_sse2_lanes _lcs_simd_lanes;
+#define LCS_HAVE_SIMD_LANES
+#endif
+
+// Bit-parallel computation of the length of the longest common
+// substring (Allison-Dix, in the formulation of Hyyro), which processes
+// 64 cells of the dynamic programming table per machine word.
+//
+// The match masks of A are built once, so a single instance can be
+// compared against many sequences; length_batch compares several of them
+// at once in the lanes of SSE2 or AVX2 registers.
+//
+// Time complexity: O(N * M / 64) per comparison, where N is the length of
+//      the sequence given to the constructor.
+//
+// Sample usage:
+//      lcs_bit_matcher<std::string> matcher("ABABC");
+//      matcher.length("BABCA"); // 3
+template <class Iterable>
+class lcs_bit_matcher {
+public:
+    typedef typename Iterable::value_type value_type;
+
+    // Builds one bit mask per distinct symbol of A, where bit i of the
+    // mask of c is set iff A[i] == c.
+    //
+    // Args:
+    //      A: sequence to compare against
+    explicit lcs_bit_matcher(const Iterable& A)
+        : size(A.size()), words((A.size() + 63) / 64),
+          alphabet(A.begin(), A.end()) {
+        std::sort(alphabet.begin(), alphabet.end());
+        alphabet.erase(std::unique(alphabet.begin(), alphabet.end()),
+                       alphabet.end());
+
+        // The extra row of zeros stands for symbols missing from A.
+        masks.assign((alphabet.size() + 1) * words, 0);
+        for (size_t i = 0; i < size; ++i) {
+            size_t symbol = std::lower_bound(alphabet.begin(), alphabet.end(),
+                                             A[i]) - alphabet.begin();
+            masks[symbol * words + i / 64] |= std::uint64_t(1) << (i % 64);
+        }
+    }
+
+    // Returns the length of the longest common substring between the
+    // sequence given to the constructor and B.
+    int length(const Iterable& B) const {
+        if (size == 0)
+            return 0;
+
+        // Zero bits of V mark the positions of A where the length of the
+        // longest common substring increases.
+        std::vector<std::uint64_t> V(words, ~std::uint64_t(0));
+
+        for (const auto& b : B) {
+            auto it = std::lower_bound(alphabet.begin(), alphabet.end(), b);
+            if (it == alphabet.end() || *it != b)
+                continue;
+
+            const std::uint64_t* mask =
+                &masks[(it - alphabet.begin()) * words];
+
+            // V = (V + U) | (V - U), where U = V & mask, with the carry
+            // propagated across words. U is a subset of V, so V - U never
+            // borrows and is simply V & ~mask.
+            std::uint64_t carry = 0;
+            for (size_t w = 0; w < words; ++w) {
+                std::uint64_t v = V[w];
+                std::uint64_t u = v & mask[w];
+
+                std::uint64_t sum = v + u;
+                std::uint64_t next_carry = sum < v;
+                sum += carry;
+                carry = next_carry | (sum < carry);
+
+                V[w] = sum | (v & ~mask[w]);
             }
         }
 
-    Iterable result;
+        return count_zeros(V.data(), 1);
+    }
 
-    int i = A.size(), j = B.size();
-    while (i != 0 && j != 0) {
-        if (A[i - 1] == B[j - 1]) {
-            result.push_back(A[i - 1]);
-            --i, --j;
-        } else if (best[i - 1][j] > best[i][j - 1]) {
-            --i;
-        } else {
-            --j;
+    // Returns the lengths of the longest common substrings between the
+    // sequence given to the constructor and each element of others.
+    //
+    // When SSE2 or AVX2 is available, the sequences are compared two or
+    // four at a time, one per 64-bit lane of a vector register.
+    std::vector<int> length_batch(const std::vector<Iterable>& others) const {
+        std::vector<int> result(others.size(), 0);
+        if (size == 0)
+            return result;
+
+        size_t i = 0;
+#ifdef LCS_HAVE_SIMD_LANES
+        const int width = _lcs_simd_lanes::width;
+        for (; i + width <= others.size(); i += width) {
+            const Iterable* group[width];
+            for (int l = 0; l < width; ++l)
+                group[l] = &others[i + l];
+            _length_lanes<_lcs_simd_lanes>(group, &result[i]);
         }
+#endif
+        for (; i < others.size(); ++i)
+            result[i] = length(others[i]);
+
+        return result;
     }
 
-    std::reverse(result.begin(), result.end());
+private:
+    // Returns the match mask of b, or a mask of zeros if b is not in A.
+    const std::uint64_t* mask_of(const value_type& b) const {
+        auto it = std::lower_bound(alphabet.begin(), alphabet.end(), b);
+        if (it == alphabet.end() || *it != b)
+            return &masks[alphabet.size() * words];
 
-    return result;
+        return &masks[(it - alphabet.begin()) * words];
+    }
+
+    // Returns the number of zero bits among the first size bits of the
+    // bit vector V, whose words are stride apart.
+    int count_zeros(const std::uint64_t* V, size_t stride) const {
+        int result = 0;
+        for (size_t w = 0; w < words; ++w) {
+            std::uint64_t zeros = ~V[w * stride];
+            if (w == words - 1 && size % 64 != 0)
+                zeros &= (std::uint64_t(1) << (size % 64)) - 1;
+            result += __builtin_popcountll(zeros);
+        }
+
+        return result;
+    }
+
+    // Runs length() on Lanes::width sequences at once. Word w of the bit
+    // vector of lane l is kept at V[w * width + l]; a lane whose sequence
+    // has ended is fed the mask of zeros, which leaves its vector
+    // unchanged.
+    template <class Lanes>
+    void _length_lanes(const Iterable* const* B, int* result) const {
+        typedef typename Lanes::reg reg;
+        const int width = Lanes::width;
+
+        size_t longest = 0;
+        for (int l = 0; l < width; ++l)
+            longest = std::max(longest, B[l]->size());
+
+        std::vector<std::uint64_t> V(words * width, ~std::uint64_t(0));
+        const std::uint64_t* zero_row = &masks[alphabet.size() * words];
+
+        for (size_t t = 0; t < longest; ++t) {
+            const std::uint64_t* rows[width];
+            for (int l = 0; l < width; ++l)
+                rows[l] = t < B[l]->size() ? mask_of((*B[l])[t]) : zero_row;
+
+            // Same update as in length(). Without unsigned comparisons,
+            // the carry out of s = a + b is the top bit of
+            // (a & b) | ((a | b) & ~s).
+            reg carry = Lanes::zero();
+            for (size_t w = 0; w < words; ++w) {
+                reg v = Lanes::load(&V[w * width]);
+                reg mask = Lanes::gather(rows, w);
+                reg u = Lanes::bit_and(v, mask);
+
+                reg sum = Lanes::add(v, u);
+                reg next_carry = Lanes::top_bit(Lanes::bit_or(
+                        Lanes::bit_and(v, u),
+                        Lanes::and_not(sum, Lanes::bit_or(v, u))));
+                reg total = Lanes::add(sum, carry);
+                carry = Lanes::bit_or(next_carry, Lanes::top_bit(
+                        Lanes::and_not(total, sum)));
+
+                Lanes::store(&V[w * width], Lanes::bit_or(
+                        total, Lanes::and_not(mask, v)));
+            }
+        }
+
+        for (int l = 0; l < width; ++l)
+            result[l] = count_zeros(&V[l], width);
+    }
+
+    size_t size;
+    size_t words;
+    std::vector<value_type> alphabet;
+    std::vector<std::uint64_t> masks;
+};
+
+// Returns the length of the longest common substring between A and B,
+// without reconstructing it. See lcs_bit_matcher.
+template <class Iterable>
+int lcs_length(const Iterable& A, const Iterable& B)
+{
+    return lcs_bit_matcher<Iterable>(A).length(B);
+}
+
+// Returns the lengths of the longest common substrings between A and
+// each element of others, reusing the match masks of A.
+template <class Iterable>
+std::vector<int> lcs_length_batch(const Iterable& A,
+                                  const std::vector<Iterable>& others)
+{
+    return lcs_bit_matcher<Iterable>(A).length_batch(others);
 }
 
 int main()
@@ -80,5 +647,29 @@ int main()
         fout << *it << " ";
     fout << "\n";
 
+    // The checks below print their results to stdout; the expected
+    // values are in the comments.
+    std::string X = "ABCBDAB", Y = "BDCABA";
+    std::cout << longest_common_substring(A, B, 0).size() << " "
+              << longest_common_substring(X, Y, 0).size() << " "
+              << longest_common_substring(X, Y).size() << std::endl; // 2 4 4
+
+    std::vector<std::string> others = {Y, X, "", "XYZ", "BD"};
+    std::cout << lcs_length(A, B) << " " << lcs_length(X, Y) << " |";
+    for (int length : lcs_length_batch(X, others))
+        std::cout << " " << length;
+    std::cout << std::endl;                             // 2 4 | 4 7 0 0 2
+
+    std::cout << (longest_common_substring_parallel(A, B, 2, 2) == result)
+              << " "
+              << longest_common_substring_parallel(X, Y, 4, 2).size() << " "
+              << longest_common_substring_parallel(X, Y, 4, 2, 0).size()
+              << std::endl;                                     // 1 4 4
+    try {
+        longest_common_substring_parallel(X, Y, 2, 0);
+    } catch (const std::invalid_argument&) {
+        std::cout << "tile 0 rejected" << std::endl;
+    }
+
     return 0;
 }
@@ -0,0 +1,422 @@
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Implementation of suffix arrays and their applications.
+//
+// The suffix array of a sequence is the sorted list of the starting
+// positions of all its suffixes. Together with the LCP array (the length
+// of the longest common prefix of each pair of adjacent suffixes in that
+// order) it answers many substring queries in linear time.
+//
+// For more information: https://en.wikipedia.org/wiki/Suffix_array
+
+// Builds the suffix array of s with the SA-IS (induced sorting)
+// algorithm.
+//
+// Time complexity: O(N + upper)
+//
+// Args:
+//      s: sequence whose elements are in [0, upper]
+//      upper: largest value that may appear in s
+//
+// Returns: the starting positions of the suffixes of s, in sorted order
+//
+// Index is the signed integer type of the elements and positions: int for
+// sequences shorter than 2^31, a 64-bit type such as std::int64_t beyond.
+template <class Index>
+std::vector<Index> suffix_array(const std::vector<Index>& s, Index upper)
+{
+    Index n = s.size();
+    if (n == 0)
+        return std::vector<Index>();
+    if (n == 1)
+        return std::vector<Index>(1, 0);
+    if (n == 2) {
+        std::vector<Index> sa(2);
+        sa[0] = s[0] < s[1] ? 0 : 1;
+        sa[1] = 1 - sa[0];
+        return sa;
+    }
+
+    std::vector<Index> sa(n);
+
+    // ls[i] - whether the suffix starting at i is S-type, i.e. smaller
+    //      than the suffix starting at i + 1
+    std::vector<bool> ls(n);
+    for (Index i = n - 2; i >= 0; --i)
+        ls[i] = s[i] == s[i + 1] ? ls[i + 1] : s[i] < s[i + 1];
+
+    // Start of the L-type and S-type parts of every bucket.
+    std::vector<Index> sum_l(upper + 1), sum_s(upper + 1);
+    for (Index i = 0; i < n; ++i) {
+        if (!ls[i])
+            ++sum_s[s[i]];
+        else
+            ++sum_l[s[i] + 1];
+    }
+    for (Index i = 0; i <= upper; ++i) {
+        sum_s[i] += sum_l[i];
+        if (i < upper)
+            sum_l[i + 1] += sum_s[i];
+    }
+
+    // Sorts all suffixes, given the LMS suffixes in sorted order.
+    std::vector<Index> buf(upper + 1);
+    auto induce = [&](const std::vector<Index>& lms) {
+        std::fill(sa.begin(), sa.end(), -1);
+
+        std::copy(sum_s.begin(), sum_s.end(), buf.begin());
+        for (Index d : lms)
+            if (d != n)
+                sa[buf[s[d]]++] = d;
+
+        std::copy(sum_l.begin(), sum_l.end(), buf.begin());
+        sa[buf[s[n - 1]]++] = n - 1;
+        for (Index i = 0; i < n; ++i) {
+            Index v = sa[i];
+            if (v >= 1 && !ls[v - 1])
+                sa[buf[s[v - 1]]++] = v - 1;
+        }
+
+        std::copy(sum_l.begin(), sum_l.end(), buf.begin());
+        for (Index i = n - 1; i >= 0; --i) {
+            Index v = sa[i];
+            if (v >= 1 && ls[v - 1])
+                sa[--buf[s[v - 1] + 1]] = v - 1;
+        }
+    };
+
+    // LMS positions: S-type suffixes preceded by an L-type suffix.
+    std::vector<Index> lms_map(n + 1, -1);
+    std::vector<Index> lms;
+    for (Index i = 1; i < n; ++i)
+        if (!ls[i - 1] && ls[i]) {
+            lms_map[i] = lms.size();
+            lms.push_back(i);
+        }
+    Index m = lms.size();
+
+    induce(lms);
+
+    if (m != 0) {
+        std::vector<Index> sorted_lms;
+        sorted_lms.reserve(m);
+        for (Index v : sa)
+            if (lms_map[v] != -1)
+                sorted_lms.push_back(v);
+
+        // Name the LMS substrings, so that equal substrings get equal
+        // names, and sort the LMS suffixes recursively.
+        std::vector<Index> rec_s(m);
+        Index rec_upper = 0;
+        rec_s[lms_map[sorted_lms[0]]] = 0;
+        for (Index i = 1; i < m; ++i) {
+            Index l = sorted_lms[i - 1], r = sorted_lms[i];
+            Index end_l = lms_map[l] + 1 < m ? lms[lms_map[l] + 1] : n;
+            Index end_r = lms_map[r] + 1 < m ? lms[lms_map[r] + 1] : n;
+
+            bool same = true;
+            if (end_l - l != end_r - r) {
+                same = false;
+            } else {
+                while (l < end_l && s[l] == s[r])
+                    ++l, ++r;
+                if (l == n || s[l] != s[r])
+                    same = false;
+            }
+
+            if (!same)
+                ++rec_upper;
+            rec_s[lms_map[sorted_lms[i]]] = rec_upper;
+        }
+
+        // Free the position map before recursing, which lowers the peak
+        // memory use by N entries.
+        std::vector<Index>().swap(lms_map);
+
+        std::vector<Index> rec_sa = suffix_array(rec_s, rec_upper);
+        for (Index i = 0; i < m; ++i)
+            sorted_lms[i] = lms[rec_sa[i]];
+        induce(sorted_lms);
+    }
+
+    return sa;
+}
+
+// Builds the permuted LCP array with Kasai's algorithm, in the variant
+// of Karkkainen, Manzini and Puglisi, which needs no inverse suffix
+// array: each suffix first records its predecessor in the suffix array,
+// and the entries are then overwritten, in text order, with the LCP
+// values.
+//
+// Time complexity: O(N)
+//
+// Args:
+//      s: sequence the suffix array was built for
+//      sa: suffix array of s
+//
+// Returns: a vector plcp where plcp[p] is the length of the longest
+//      common prefix of the suffix starting at p and the one before it in
+//      the suffix array, or 0 if it is the first
+template <class Index>
+std::vector<Index> permuted_lcp_array(const std::vector<Index>& s,
+                                      const std::vector<Index>& sa)
+{
+    Index n = s.size();
+    std::vector<Index> plcp(n);
+    if (n == 0)
+        return plcp;
+
+    plcp[sa[0]] = -1;
+    for (Index i = 1; i < n; ++i)
+        plcp[sa[i]] = sa[i - 1];
+
+    Index h = 0;
+    for (Index i = 0; i < n; ++i) {
+        Index j = plcp[i];
+        if (j == -1) {
+            plcp[i] = 0;
+            h = 0;
+            continue;
+        }
+
+        while (i + h < n && j + h < n && s[i + h] == s[j + h])
+            ++h;
+        plcp[i] = h;
+
+        if (h > 0)
+            --h;
+    }
+
+    return plcp;
+}
+
+// Builds the LCP array, in suffix array order.
+//
+// Time complexity: O(N)
+//
+// Args:
+//      s: sequence the suffix array was built for
+//      sa: suffix array of s
+//
+// Returns: a vector lcp where lcp[i] is the length of the longest common
+//      prefix of the suffixes starting at sa[i - 1] and sa[i], and
+//      lcp[0] = 0
+template <class Index>
+std::vector<Index> lcp_array(const std::vector<Index>& s,
+                             const std::vector<Index>& sa)
+{
+    std::vector<Index> plcp = permuted_lcp_array(s, sa);
+
+    std::vector<Index> lcp(sa.size());
+    for (size_t i = 0; i < sa.size(); ++i)
+        lcp[i] = plcp[sa[i]];
+
+    return lcp;
+}
+
+// Maps the elements of a collection of sequences to dense ranks
+// [0, size()), preserving their order. The general version sorts the
+// distinct elements.
+template <class T, bool Byte = std::is_integral<T>::value && sizeof(T) == 1>
+class _suffix_alphabet {
+public:
+    template <class Iterable>
+    explicit _suffix_alphabet(const std::vector<Iterable>& strings) {
+        for (const auto& str : strings)
+            symbols.insert(symbols.end(), str.begin(), str.end());
+        std::sort(symbols.begin(), symbols.end());
+        symbols.erase(std::unique(symbols.begin(), symbols.end()),
+                      symbols.end());
+    }
+
+    int size() const { return symbols.size(); }
+    int rank(const T& c) const {
+        return std::lower_bound(symbols.begin(), symbols.end(), c)
+            - symbols.begin();
+    }
+    const T& symbol(int r) const { return symbols[r]; }
+
+private:
+    std::vector<T> symbols;
+};
+
+// Byte alphabets are ranked with a table of 256 entries, without copying
+// or sorting the input.
+template <class T>
+class _suffix_alphabet<T, true> {
+public:
+    template <class Iterable>
+    explicit _suffix_alphabet(const std::vector<Iterable>& strings) {
+        bool present[256] = {};
+        for (const auto& str : strings)
+            for (const auto& c : str)
+                present[static_cast<unsigned char>(c)] = true;
+
+        // Visit the bytes in the order of T, which may be signed.
+        for (int v = std::numeric_limits<T>::min();
+                v <= std::numeric_limits<T>::max(); ++v) {
+            unsigned char byte = static_cast<unsigned char>(v);
+            ranks[byte] = symbols.size();
+            if (present[byte])
+                symbols.push_back(static_cast<T>(v));
+        }
+    }
+
+    int size() const { return symbols.size(); }
+    int rank(const T& c) const { return ranks[static_cast<unsigned char>(c)]; }
+    const T& symbol(int r) const { return symbols[r]; }
+
+private:
+    int ranks[256];
+    std::vector<T> symbols;
+};
+
+// Implementation of longest_common_substring, with positions of type
+// Index.
+template <class Index, class Iterable>
+Iterable _longest_common_substring(const std::vector<Iterable>& strings)
+{
+    const Index k = strings.size();
+
+    typedef typename Iterable::value_type value_type;
+    _suffix_alphabet<value_type> alphabet(strings);
+    const Index sigma = alphabet.size();
+
+    // Separators rank above every element, so the suffixes starting
+    // with them come last in the suffix array. starts[i] is the position
+    // of the first element of strings[i] in text.
+    std::vector<Index> text;
+    std::vector<Index> starts;
+    size_t total = k;
+    for (const auto& str : strings)
+        total += str.size();
+    text.reserve(total);
+    for (Index i = 0; i < k; ++i) {
+        starts.push_back(text.size());
+        for (const auto& c : strings[i])
+            text.push_back(alphabet.rank(c));
+        text.push_back(sigma + i);
+    }
+
+    // The LCP values are read in text order, through plcp, to save an
+    // array of N entries over lcp_array.
+    std::vector<Index> sa = suffix_array(text, sigma + k - 1);
+    std::vector<Index> plcp = permuted_lcp_array(text, sa);
+    auto lcp = [&](Index i) {
+        return plcp[sa[i]];
+    };
+
+    // Returns the index of the string containing position pos.
+    auto owner = [&](Index pos) {
+        return std::upper_bound(starts.begin(), starts.end(), pos)
+            - starts.begin() - 1;
+    };
+
+    const Index n = text.size() - k;
+    std::vector<Index> seen(k);
+    Index covered = 0;
+    Index best_len = 0, best_pos = 0;
+
+    // Indices i in (left, right] of the window, with lcp[i] increasing.
+    std::deque<Index> window;
+    for (Index right = 0, left = 0; right < n; ++right) {
+        if (seen[owner(sa[right])]++ == 0)
+            ++covered;
+
+        while (!window.empty() && lcp(window.back()) >= lcp(right))
+            window.pop_back();
+        window.push_back(right);
+
+        while (covered == k) {
+            while (!window.empty() && window.front() <= left)
+                window.pop_front();
+            if (!window.empty() && lcp(window.front()) > best_len) {
+                best_len = lcp(window.front());
+                best_pos = sa[right];
+            }
+
+            if (--seen[owner(sa[left])] == 0)
+                --covered;
+            ++left;
+        }
+    }
+
+    Iterable result;
+    for (Index i = best_pos; i < best_pos + best_len; ++i)
+        result.push_back(alphabet.symbol(text[i]));
+
+    return result;
+}
+
+// Finds the longest contiguous sequence that appears in every element of
+// strings. The strings are concatenated with distinct separators, and a
+// sliding window over the suffix array looks for the largest minimum LCP
+// among runs of suffixes that start in all of the strings.
+//
+// Positions are 32-bit when the concatenation is shorter than 2^31, and
+// 64-bit beyond, so inputs of several gigabytes are supported.
+//
+// Time complexity: O(L * log(L)) to rank the elements (O(L) for byte
+//      alphabets), O(L * log(K)) for the rest, where L is the total
+//      length of the K strings
+//
+// Args:
+//      strings: sequences whose elements can be sorted and compared
+//
+// Returns: the longest common substring (empty if there is none)
+template <class Iterable>
+Iterable longest_common_substring(const std::vector<Iterable>& strings)
+{
+    if (strings.empty())
+        return Iterable();
+    if (strings.size() == 1)
+        return strings[0];
+
+    size_t total = strings.size();
+    for (const auto& str : strings)
+        total += str.size();
+
+    // The alphabet and separators take at most 256 + K extra names for
+    // byte alphabets, and at most L + K otherwise, well below 2^31 - 1
+    // whenever L + K is.
+    if (total < static_cast<size_t>(std::numeric_limits<int>::max()) / 2)
+        return _longest_common_substring<int>(strings);
+    return _longest_common_substring<std::int64_t>(strings);
+}
+
+// Finds the longest contiguous sequence that appears in both A and B.
+// See the version taking a vector of strings.
+template <class Iterable>
+Iterable longest_common_substring(const Iterable& A, const Iterable& B)
+{
+    std::vector<Iterable> strings;
+    strings.push_back(A);
+    strings.push_back(B);
+
+    return longest_common_substring(strings);
+}
+
+// Test code
+int main()
+{
+    std::string A = "ABABC", B = "BABCA";
+    std::cout << longest_common_substring(A, B) << "\n"; // BABC
+
+    std::vector<std::string> logs;
+    logs.push_back("error: disk /dev/sda1 is full");
+    logs.push_back("warning: disk /dev/sdb1 is almost full");
+    logs.push_back("disk /dev/sdc1 is full again");
+    std::cout << longest_common_substring(logs) << "\n"; // "disk /dev/sd"
+
+    std::vector<int> X = {1, 2, 3, 4, 5}, Y = {9, 3, 4, 5, 1};
+    std::cout << longest_common_substring(X, Y).size() << "\n"; // 3
+
+    return 0;
+}
@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Implementation of a Trie supporting lock-free lookups concurrent with
+// insertions.
+//
+// Any number of threads may call count while other threads insert. The
+// children of a node are an immutable sorted array published through an
+// atomic pointer: an insertion builds a copy of the array with the new
+// child and swaps it in, so readers only ever see complete arrays and
+// never wait. Writers are serialized among themselves by a mutex, which
+// readers never take.
+//
+// Replaced arrays cannot be freed while a reader may still be walking
+// them. They are reclaimed with epoch-based reclamation: readers
+// announce themselves in one of two counters chosen by the parity of a
+// global epoch, and before freeing, the writer advances the epoch and
+// waits for the counters of the previous epoch to drain.
+//
+// Lookups take O(length * log(alphabet)) time; insertions copy the child
+// array of the node they extend.
+//
+// Sample usage:
+//      concurrent_trie t;
+//      std::thread writer([&]() { t.insert("banana"); });
+//      t.count("banana"); // 0 or 1, depending on the interleaving
+//      writer.join();
+class concurrent_trie {
+public:
+    concurrent_trie();
+    ~concurrent_trie();
+
+    concurrent_trie(const concurrent_trie&) = delete;
+    concurrent_trie& operator=(const concurrent_trie&) = delete;
+
+    void insert(const std::string& word);
+    int count(const std::string& word) const;
+
+private:
+    struct node;
+    typedef std::vector<std::pair<unsigned char, node*>> edges;
+
+    struct node {
+        node(): children(nullptr), word_end(false) {}
+
+        std::atomic<const edges*> children;
+        std::atomic<bool> word_end;
+    };
+
+    // Number of retired arrays after which the writer reclaims them.
+    static const size_t reclaim_threshold = 1024;
+    static const int stripes = 64;
+
+    // Reader counters for even and odd epochs, padded to a cache line
+    // and spread over stripes to avoid contention between readers.
+    struct alignas(64) stripe {
+        std::atomic<long> active[2];
+    };
+
+    static node* child(const node* n, unsigned char c);
+    static void destroy(node* n);
+    stripe& reader_stripe() const;
+    void synchronize();
+
+    node* root;
+
+    std::mutex writer;
+    std::vector<const edges*> retired;
+
+    mutable std::atomic<unsigned long> epoch;
+    mutable stripe readers[stripes];
+};
+
+concurrent_trie::concurrent_trie(): root(new node()), epoch(0) {
+    for (int i = 0; i < stripes; ++i) {
+        readers[i].active[0].store(0, std::memory_order_relaxed);
+        readers[i].active[1].store(0, std::memory_order_relaxed);
+    }
+}
+
+concurrent_trie::~concurrent_trie() {
+    destroy(root);
+    for (const edges* e : retired)
+        delete e;
+}
+
+void concurrent_trie::destroy(node* n) {
+    const edges* e = n->children.load(std::memory_order_relaxed);
+    if (e != nullptr) {
+        for (const auto& kv : *e)
+            destroy(kv.second);
+        delete e;
+    }
+    delete n;
+}
+
+// Returns the child of n through c, or nullptr.
+concurrent_trie::node* concurrent_trie::child(const node* n,
+                                              unsigned char c) {
+    const edges* e = n->children.load(std::memory_order_acquire);
+    if (e == nullptr)
+        return nullptr;
+
+    auto it = std::lower_bound(e->begin(), e->end(), c,
+            [](const std::pair<unsigned char, node*>& kv, unsigned char v) {
+        return kv.first < v;
+    });
+    if (it == e->end() || it->first != c)
+        return nullptr;
+
+    return it->second;
+}
+
+concurrent_trie::stripe& concurrent_trie::reader_stripe() const {
+    static thread_local size_t id =
+        std::hash<std::thread::id>()(std::this_thread::get_id());
+    return readers[id % stripes];
+}
+
+// Insert a word into the trie. Safe to call concurrently with count and
+// with other insertions.
+//
+// Args:
+//      word: string to be inserted
+void concurrent_trie::insert(const std::string& word) {
+    std::lock_guard<std::mutex> lock(writer);
+
+    node* n = root;
+    for (unsigned char c : word) {
+        node* next = child(n, c);
+        if (next == nullptr) {
+            next = new node();
+
+            const edges* old = n->children.load(std::memory_order_relaxed);
+            edges* updated = old == nullptr ? new edges() : new edges(*old);
+            updated->insert(std::lower_bound(updated->begin(), updated->end(),
+                                             std::make_pair(c, next)),
+                            std::make_pair(c, next));
+
+            // Publish the fully built array; readers holding the old one
+            // keep a consistent, if stale, view.
+            n->children.store(updated, std::memory_order_release);
+            if (old != nullptr)
+                retired.push_back(old);
+        }
+        n = next;
+    }
+    n->word_end.store(true, std::memory_order_release);
+
+    if (retired.size() >= reclaim_threshold)
+        synchronize();
+}
+
+// Frees the retired arrays once no reader can still hold them. Called
+// with the writer mutex held; may wait for readers, but readers never
+// wait for it.
+void concurrent_trie::synchronize() {
+    unsigned long e = epoch.load(std::memory_order_relaxed);
+    epoch.store(e + 1, std::memory_order_seq_cst);
+
+    // Readers that entered during epoch e may still see the old arrays.
+    for (int i = 0; i < stripes; ++i)
+        while (readers[i].active[e & 1].load(std::memory_order_seq_cst) != 0)
+            std::this_thread::yield();
+
+    for (const edges* old : retired)
+        delete old;
+    retired.clear();
+}
+
+// Count the number of appearances of the word.
+// Will return 1 if the trie contains word and 0 otherwise. Lock-free,
+// and safe to call concurrently with insert.
+//
+// Args:
+//      word: string to search for
+int concurrent_trie::count(const std::string& word) const {
+    stripe& s = reader_stripe();
+
+    // Announce the reader in the current epoch. If the epoch moved on in
+    // the meantime, the writer may not have seen the announcement, so
+    // try again in the new epoch.
+    unsigned long e;
+    for (;;) {
+        e = epoch.load(std::memory_order_seq_cst);
+        s.active[e & 1].fetch_add(1, std::memory_order_seq_cst);
+        if (epoch.load(std::memory_order_seq_cst) == e)
+            break;
+        s.active[e & 1].fetch_sub(1, std::memory_order_release);
+    }
+
+    const node* n = root;
+    for (unsigned char c : word) {
+        n = child(n, c);
+        if (n == nullptr)
+            break;
+    }
+    int result = n != nullptr && n->word_end.load(std::memory_order_acquire);
+
+    s.active[e & 1].fetch_sub(1, std::memory_order_release);
+
+    return result;
+}
+
+int main()
+{
+    concurrent_trie t;
+    t.insert("banana");
+
+    std::thread writer([&]() {
+        for (int i = 0; i < 10000; ++i)
+            t.insert("band" + std::to_string(i));
+    });
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r)
+        readers.push_back(std::thread([&]() {
+            for (int i = 0; i < 10000; ++i)
+                t.count("band" + std::to_string(i));
+        }));
+
+    writer.join();
+    for (auto& reader : readers)
+        reader.join();
+
+    std::cout << t.count("ban") << std::endl;
+    std::cout << t.count("banana") << std::endl;
+    std::cout << t.count("band9999") << std::endl;
+
+    // Throughput of one writer inserting 100000 words while a growing
+    // number of readers look words up; the timings depend on the machine.
+    std::vector<std::string> words;
+    for (int i = 0; i < 100000; ++i)
+        words.push_back("word" + std::to_string(i * 7919 % 100000));
+
+    for (int count = 1; count <= 8; count *= 2) {
+        concurrent_trie bench;
+        std::atomic<bool> done(false);
+        std::atomic<long long> lookups(0);
+
+        auto start = std::chrono::steady_clock::now();
+        std::thread inserter([&]() {
+            for (const auto& word : words)
+                bench.insert(word);
+            done.store(true);
+        });
+
+        std::vector<std::thread> lookers;
+        for (int r = 0; r < count; ++r)
+            lookers.push_back(std::thread([&, r]() {
+                long long local = 0;
+                for (size_t i = r; !done.load(); i = (i + 1) % words.size()) {
+                    bench.count(words[i]);
+                    ++local;
+                }
+                lookups += local;
+            }));
+
+        inserter.join();
+        for (auto& looker : lookers)
+            looker.join();
+        double seconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+
+        std::cout << count << " readers: "
+                  << words.size() / seconds / 1e6 << " M inserts/s, "
+                  << lookups.load() / seconds / 1e6 << " M lookups/s"
+                  << std::endl;
+    }
+
+    return 0;
+}
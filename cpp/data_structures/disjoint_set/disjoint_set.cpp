@@ -1,5 +1,13 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <random>
+#include <thread>
+#include <utility>
 #include <vector>
 
 // Implementation of a disjoint_set data structure.
@@ -16,34 +24,25 @@
 class disjoint_set {
 public:
     explicit disjoint_set(int N);
-    ~disjoint_set();
 
     int find(int val);
     void unite(int lhs, int rhs);
     bool same_component(int lhs, int rhs);
 
 private:
-    int *parent;
-    int *rank;
+    std::vector<int> parent;
+    std::vector<int> rank;
 };
 
 // Constructs a disjoint-set of specified size.
 //
 // Args:
 //      size: size of the resulting data structure
-disjoint_set::disjoint_set(int size) {
-    parent = new int[size];
-    rank = new int[size];
-
+disjoint_set::disjoint_set(int size): parent(size), rank(size, 0) {
     for (int i = 0; i < size; ++i)
         parent[i] = i;
 }
 
-disjoint_set::~disjoint_set() {
-    delete[] parent;
-    delete[] rank;
-}
-
 // Find the component in which val is located.
 //
 // Args:
@@ -68,6 +67,8 @@ int disjoint_set::find(int val) {
 void disjoint_set::unite(int lhs, int rhs) {
     int parent_lhs = find(lhs);
     int parent_rhs = find(rhs);
+    if (parent_lhs == parent_rhs)
+        return;
 
     // To avoid having an unbalanced tree, a union pairs the lower
     // weighted sub-tree as the child of the heavier sub-tree.
@@ -93,6 +94,553 @@ bool disjoint_set::same_component(int lhs, int rhs) {
     return find(lhs) == find(rhs);
 }
 
+// Prefetches the cache line holding *addr for writing, on compilers that
+// support it.
+#if defined(__GNUC__)
+#define DISJOINT_SET_PREFETCH(addr) __builtin_prefetch((addr), 1)
+#else
+#define DISJOINT_SET_PREFETCH(addr) ((void) 0)
+#endif
+
+// Implementation of a disjoint_set laid out for large, cache-unfriendly
+// workloads.
+//
+// Parent and size share a single array of 32-bit integers: a
+// non-negative entry is the parent of the element, and a negative entry
+// marks a root and holds minus the size of its component. A find thus
+// touches one cache line per step instead of two, and the whole
+// structure takes 4 bytes per element. Finds are iterative and use path
+// halving, which makes every other node on the path point to its
+// grandparent in a single pass.
+//
+// When the elements are accessed at random the cost of a find is
+// dominated by cache misses, so find_many and unite_many process a batch
+// of queries and prefetch the entries of the queries a few positions
+// ahead, overlapping their misses with the current work.
+//
+// Sample usage:
+//      compact_disjoint_set ds(1000);
+//      std::pair<int, int> edges[] = {{1, 2}, {2, 3}};
+//      ds.unite_many(edges, 2);
+//      ds.same_component(1, 3); // true
+class compact_disjoint_set {
+public:
+    explicit compact_disjoint_set(int size): data(size, -1) {}
+
+    int find(int val);
+    bool unite(int lhs, int rhs);
+    bool same_component(int lhs, int rhs);
+    int component_size(int val);
+
+    void find_many(const int* vals, size_t count, int* roots);
+    size_t unite_many(const std::pair<int, int>* pairs, size_t count);
+
+private:
+    // Number of queries ahead of the current one whose entries are
+    // prefetched by the batch operations.
+    static const size_t prefetch_distance = 16;
+
+    std::vector<int> data;
+};
+
+// Find the component in which val is located.
+//
+// Args:
+//      val: the element for which we want to find the enclosing component
+//
+// Returns: the root element of the component containing val
+int compact_disjoint_set::find(int val) {
+    while (data[val] >= 0) {
+        int parent = data[val];
+        int grandparent = data[parent];
+        if (grandparent < 0)
+            return parent;
+
+        data[val] = grandparent;
+        val = grandparent;
+    }
+
+    return val;
+}
+
+// Unite the components which contain lhs and rhs, attaching the smaller
+// component below the larger one.
+//
+// Args:
+//      lhs: element of component to unite with component of rhs
+//      rhs: element of component to unite with component of lhs
+//
+// Returns: true if the components were different before the call
+bool compact_disjoint_set::unite(int lhs, int rhs) {
+    lhs = find(lhs);
+    rhs = find(rhs);
+    if (lhs == rhs)
+        return false;
+
+    // Sizes are stored negated, so the larger component has the smaller
+    // entry.
+    if (data[lhs] < data[rhs])
+        std::swap(lhs, rhs);
+    data[rhs] += data[lhs];
+    data[lhs] = rhs;
+
+    return true;
+}
+
+// Query whether lhs and rhs are in the same component.
+//
+// Args:
+//      lhs: component to query
+//      rhs: component to query
+//
+// Returns: true if lhs and rhs are in the same component,
+//      false otherwise
+bool compact_disjoint_set::same_component(int lhs, int rhs) {
+    return find(lhs) == find(rhs);
+}
+
+// Returns the number of elements in the component containing val.
+int compact_disjoint_set::component_size(int val) {
+    return -data[find(val)];
+}
+
+// Finds the roots of a batch of elements.
+//
+// Args:
+//      vals: elements to look up
+//      count: number of elements in vals
+//      roots: output array of count entries; roots[i] receives find(vals[i])
+void compact_disjoint_set::find_many(const int* vals, size_t count,
+                                     int* roots) {
+    for (size_t i = 0; i < count && i < prefetch_distance; ++i)
+        DISJOINT_SET_PREFETCH(&data[vals[i]]);
+
+    for (size_t i = 0; i < count; ++i) {
+        if (i + prefetch_distance < count)
+            DISJOINT_SET_PREFETCH(&data[vals[i + prefetch_distance]]);
+        roots[i] = find(vals[i]);
+    }
+}
+
+// Unites the components of each pair in a batch, in order.
+//
+// Args:
+//      pairs: pairs of elements whose components are to be united
+//      count: number of pairs
+//
+// Returns: the number of unions that merged two different components
+size_t compact_disjoint_set::unite_many(const std::pair<int, int>* pairs,
+                                        size_t count) {
+    for (size_t i = 0; i < count && i < prefetch_distance; ++i) {
+        DISJOINT_SET_PREFETCH(&data[pairs[i].first]);
+        DISJOINT_SET_PREFETCH(&data[pairs[i].second]);
+    }
+
+    size_t merged = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (i + prefetch_distance < count) {
+            DISJOINT_SET_PREFETCH(&data[pairs[i + prefetch_distance].first]);
+            DISJOINT_SET_PREFETCH(&data[pairs[i + prefetch_distance].second]);
+        }
+        merged += unite(pairs[i].first, pairs[i].second);
+    }
+
+    return merged;
+}
+
+// Implementation of a disjoint_set that supports concurrent find, unite
+// and same_component calls from any number of threads without locks.
+//
+// Parents are kept in an array of atomics. Roots are linked with a
+// compare-and-swap on the parent of the root being attached, which fails
+// (and the operation retries) if another thread linked that root first.
+// Instead of union by rank, which would need the rank and the parent to
+// be updated together, roots are linked by a fixed pseudo-random
+// priority, which keeps the expected depth logarithmic (Jayanti and
+// Tarjan's randomized linking). Finds use path halving, where each
+// step replaces a parent by its grandparent with a single CAS; failed
+// CASes are harmless and ignored.
+//
+// For more information: https://arxiv.org/abs/1612.01514
+class concurrent_disjoint_set {
+public:
+    explicit concurrent_disjoint_set(int size);
+
+    int find(int val);
+    bool unite(int lhs, int rhs);
+    bool same_component(int lhs, int rhs);
+
+private:
+    // Root lhs is linked below root rhs iff it has the lower priority.
+    static bool lower_priority(int lhs, int rhs);
+
+    std::vector<std::atomic<int> > parent;
+};
+
+// Constructs a concurrent disjoint-set of specified size.
+//
+// Args:
+//      size: size of the resulting data structure
+concurrent_disjoint_set::concurrent_disjoint_set(int size)
+        : parent(size) {
+    for (int i = 0; i < size; ++i)
+        parent[i].store(i, std::memory_order_relaxed);
+}
+
+bool concurrent_disjoint_set::lower_priority(int lhs, int rhs) {
+    // Multiplicative hashing by an odd constant is a bijection on
+    // 32-bit values, so ties only happen for lhs == rhs.
+    uint32_t hash_lhs = static_cast<uint32_t>(lhs) * 2654435761u;
+    uint32_t hash_rhs = static_cast<uint32_t>(rhs) * 2654435761u;
+
+    return hash_lhs < hash_rhs;
+}
+
+// Find the component in which val is located. The result may be stale
+// by the time it is returned if other threads are uniting.
+//
+// Args:
+//      val: the element for which we want to find the enclosing component
+//
+// Returns: the root element of the component containing val
+int concurrent_disjoint_set::find(int val) {
+    for (;;) {
+        int p = parent[val].load(std::memory_order_acquire);
+        if (p == val)
+            return val;
+
+        int grandparent = parent[p].load(std::memory_order_acquire);
+        if (grandparent != p)
+            parent[val].compare_exchange_weak(p, grandparent,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed);
+        val = grandparent;
+    }
+}
+
+// Unite the components which contain lhs and rhs.
+//
+// Args:
+//      lhs: element of component to unite with component of rhs
+//      rhs: element of component to unite with component of lhs
+//
+// Returns: true if the components were different before the call
+bool concurrent_disjoint_set::unite(int lhs, int rhs) {
+    for (;;) {
+        lhs = find(lhs);
+        rhs = find(rhs);
+        if (lhs == rhs)
+            return false;
+
+        if (!lower_priority(lhs, rhs))
+            std::swap(lhs, rhs);
+
+        // Only succeeds if lhs is still a root.
+        int expected = lhs;
+        if (parent[lhs].compare_exchange_strong(expected, rhs,
+                                                std::memory_order_acq_rel))
+            return true;
+    }
+}
+
+// Query whether lhs and rhs are in the same component.
+//
+// Args:
+//      lhs: component to query
+//      rhs: component to query
+//
+// Returns: true if lhs and rhs are in the same component,
+//      false otherwise
+bool concurrent_disjoint_set::same_component(int lhs, int rhs) {
+    for (;;) {
+        lhs = find(lhs);
+        rhs = find(rhs);
+        if (lhs == rhs)
+            return true;
+
+        // If lhs is still a root, the two elements were in different
+        // components at the moment rhs's root was read.
+        if (parent[lhs].load(std::memory_order_acquire) == lhs)
+            return false;
+    }
+}
+
+// Implementation of a disjoint_set whose unions can be undone.
+//
+// Path compression rewrites many parent pointers per query, which would
+// make undoing a union expensive, so this variant relies on union by
+// size alone: trees stay O(log N) deep, every find is O(log N), and each
+// union changes exactly one parent pointer, which is recorded on an undo
+// stack.
+//
+// Sample usage:
+//      rollback_disjoint_set ds(10);
+//      int before = ds.snapshot();
+//      ds.unite(1, 2);
+//      ds.rollback(before); // 1 and 2 are separate again
+class rollback_disjoint_set {
+public:
+    explicit rollback_disjoint_set(int size);
+
+    int find(int val) const;
+    bool unite(int lhs, int rhs);
+    bool same_component(int lhs, int rhs) const;
+
+    int snapshot() const;
+    void rollback(int snapshot);
+
+private:
+    std::vector<int> parent;
+    std::vector<int> size;
+    // Roots attached by each successful union, in order.
+    std::vector<int> history;
+};
+
+// Constructs a rollback disjoint-set of specified size.
+//
+// Args:
+//      size: size of the resulting data structure
+rollback_disjoint_set::rollback_disjoint_set(int _size)
+        : parent(_size), size(_size, 1) {
+    for (int i = 0; i < _size; ++i)
+        parent[i] = i;
+}
+
+// Find the component in which val is located, in O(log N) time.
+//
+// Args:
+//      val: the element for which we want to find the enclosing component
+//
+// Returns: the root element of the component containing val
+int rollback_disjoint_set::find(int val) const {
+    while (val != parent[val])
+        val = parent[val];
+
+    return val;
+}
+
+// Unite the components which contain lhs and rhs.
+//
+// Args:
+//      lhs: element of component to unite with component of rhs
+//      rhs: element of component to unite with component of lhs
+//
+// Returns: true if the components were different before the call
+bool rollback_disjoint_set::unite(int lhs, int rhs) {
+    lhs = find(lhs);
+    rhs = find(rhs);
+    if (lhs == rhs)
+        return false;
+
+    // The smaller tree is attached below the larger one.
+    if (size[lhs] > size[rhs])
+        std::swap(lhs, rhs);
+    parent[lhs] = rhs;
+    size[rhs] += size[lhs];
+    history.push_back(lhs);
+
+    return true;
+}
+
+// Query whether lhs and rhs are in the same component.
+//
+// Args:
+//      lhs: component to query
+//      rhs: component to query
+//
+// Returns: true if lhs and rhs are in the same component,
+//      false otherwise
+bool rollback_disjoint_set::same_component(int lhs, int rhs) const {
+    return find(lhs) == find(rhs);
+}
+
+// Returns a token identifying the current state, to be passed to
+// rollback.
+int rollback_disjoint_set::snapshot() const {
+    return history.size();
+}
+
+// Undoes every union performed since snapshot was taken, in O(1) per
+// union.
+//
+// Args:
+//      snapshot: value previously returned by snapshot()
+void rollback_disjoint_set::rollback(int snapshot) {
+    while (static_cast<int>(history.size()) > snapshot) {
+        int child = history.back();
+        history.pop_back();
+
+        size[parent[child]] -= size[child];
+        parent[child] = child;
+    }
+}
+
+// Offline dynamic connectivity: answers connectivity queries over a
+// sequence of edge insertions and deletions, once the whole sequence is
+// known.
+//
+// Each edge is alive during an interval of queries. The intervals are
+// stored in a segment tree over the query indices, so that each one is
+// split into O(log Q) nodes. A depth-first traversal of the tree unites
+// the edges of a node on the way down and rolls them back on the way
+// up, so that at each leaf the rollback_disjoint_set holds exactly the
+// edges alive at that query.
+//
+// Time complexity: O((E * log(Q) + Q) * log(N)) overall, where E is the
+//      number of edge insertions and Q the number of queries.
+//
+// Sample usage:
+//      dynamic_connectivity dc(3);
+//      dc.add_edge(0, 1);
+//      dc.query(0, 1);
+//      dc.remove_edge(0, 1);
+//      dc.query(0, 1);
+//      dc.solve(); // {true, false}
+class dynamic_connectivity {
+public:
+    explicit dynamic_connectivity(int _size): size(_size) {}
+
+    void add_edge(int u, int v);
+    void remove_edge(int u, int v);
+    void query(int u, int v);
+
+    std::vector<bool> solve();
+
+private:
+    typedef std::pair<int, int> edge;
+
+    void insert(int node, int left, int right, int x, int y, const edge& e);
+    void traverse(int node, int left, int right, rollback_disjoint_set& ds,
+                  std::vector<bool>& answers);
+
+    int size;
+    std::vector<edge> queries;
+    // Query index at which each currently alive edge was added; an edge
+    // added several times is alive once per addition.
+    std::map<edge, std::vector<int> > alive;
+    // Edges together with the interval [first, last) of queries during
+    // which they are alive.
+    std::vector<std::pair<edge, std::pair<int, int> > > intervals;
+    std::vector<std::vector<edge> > tree;
+};
+
+// Adds the edge (u, v) after all operations recorded so far.
+void dynamic_connectivity::add_edge(int u, int v) {
+    alive[edge(std::min(u, v), std::max(u, v))].push_back(queries.size());
+}
+
+// Removes one copy of the edge (u, v). Does nothing if no copy of the
+// edge is alive.
+void dynamic_connectivity::remove_edge(int u, int v) {
+    edge e(std::min(u, v), std::max(u, v));
+    auto it = alive.find(e);
+    if (it == alive.end())
+        return;
+
+    std::vector<int>& starts = it->second;
+    intervals.push_back(std::make_pair(
+            e, std::make_pair(starts.back(), static_cast<int>(queries.size()))));
+    starts.pop_back();
+    if (starts.empty())
+        alive.erase(it);
+}
+
+// Records a query asking whether u and v are connected at this point.
+void dynamic_connectivity::query(int u, int v) {
+    queries.push_back(edge(u, v));
+}
+
+// Answers the recorded queries, in order.
+std::vector<bool> dynamic_connectivity::solve() {
+    const int q = queries.size();
+    std::vector<bool> answers(q);
+    if (q == 0)
+        return answers;
+
+    tree.assign(4 * q, std::vector<edge>());
+    for (const auto& kv : intervals)
+        if (kv.second.first < kv.second.second)
+            insert(1, 0, q - 1, kv.second.first, kv.second.second - 1,
+                   kv.first);
+    for (const auto& kv : alive)
+        for (int start : kv.second)
+            if (start < q)
+                insert(1, 0, q - 1, start, q - 1, kv.first);
+
+    rollback_disjoint_set ds(size);
+    traverse(1, 0, q - 1, ds, answers);
+
+    return answers;
+}
+
+// Adds e to the nodes covering the queries [x, y].
+void dynamic_connectivity::insert(int node, int left, int right,
+                                  int x, int y, const edge& e) {
+    if (x <= left && right <= y) {
+        tree[node].push_back(e);
+        return;
+    }
+
+    int mid = left + (right - left) / 2;
+    if (x <= mid)
+        insert(2 * node, left, mid, x, y, e);
+    if (y > mid)
+        insert(2 * node + 1, mid + 1, right, x, y, e);
+}
+
+void dynamic_connectivity::traverse(int node, int left, int right,
+                                    rollback_disjoint_set& ds,
+                                    std::vector<bool>& answers) {
+    int before = ds.snapshot();
+    for (const edge& e : tree[node])
+        ds.unite(e.first, e.second);
+
+    if (left == right) {
+        answers[left] = ds.same_component(queries[left].first,
+                                          queries[left].second);
+    } else {
+        int mid = left + (right - left) / 2;
+        traverse(2 * node, left, mid, ds, answers);
+        traverse(2 * node + 1, mid + 1, right, ds, answers);
+    }
+
+    ds.rollback(before);
+}
+
+// One operation in the disjoint.in format: op 1 unites x and y, op 2
+// asks whether they are in the same component.
+struct operation {
+    int op, x, y;
+};
+
+// Runs ops on a fresh concurrent_disjoint_set of size elements, split
+// into contiguous slices among threads.
+//
+// Returns: the elapsed time in seconds
+double time_concurrent(int size, const std::vector<operation>& ops,
+                       int threads) {
+    concurrent_disjoint_set ds(size);
+    std::vector<std::thread> workers;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t)
+        workers.push_back(std::thread([&ds, &ops, t, threads]() {
+            size_t first = ops.size() * t / threads;
+            size_t last = ops.size() * (t + 1) / threads;
+            for (size_t i = first; i < last; ++i) {
+                if (ops[i].op == 1)
+                    ds.unite(ops[i].x, ops[i].y);
+                else
+                    ds.same_component(ops[i].x, ops[i].y);
+            }
+        }));
+    for (auto& worker : workers)
+        worker.join();
+
+    return std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+}
+
 int main()
 {
     std::ifstream fin("disjoint.in");
@@ -119,5 +667,70 @@ int main()
         }
     }
 
+    // The checks below print their results to stdout; the expected
+    // values are in the comments.
+    concurrent_disjoint_set concurrent(10000);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t)
+        workers.push_back(std::thread([&concurrent, t]() {
+            for (int i = t; i + 1 < 10000; i += 4)
+                concurrent.unite(i, i + 1);
+        }));
+    for (auto& worker : workers)
+        worker.join();
+    std::cout << concurrent.same_component(0, 9999) << std::endl; // 1
+
+    // Scaling of concurrent_disjoint_set on random operations in the
+    // disjoint.in format, half unions and half queries; the timings
+    // depend on the machine.
+    const int bench_size = 1 << 20;
+    std::mt19937 rng(1);
+    std::vector<operation> ops(1 << 22);
+    for (auto& o : ops) {
+        o.op = 1 + rng() % 2;
+        o.x = rng() % bench_size;
+        o.y = rng() % bench_size;
+    }
+    for (int threads = 1; threads <= 8; threads *= 2)
+        std::cout << threads << " threads: "
+                  << ops.size() / time_concurrent(bench_size, ops, threads)
+                        / 1e6
+                  << " Mops/s" << std::endl;
+
+    rollback_disjoint_set rollback(10);
+    rollback.unite(0, 1);
+    int before = rollback.snapshot();
+    rollback.unite(1, 2);
+    std::cout << rollback.same_component(0, 2) << " ";          // 1
+    rollback.rollback(before);
+    std::cout << rollback.same_component(0, 2) << " "
+              << rollback.same_component(0, 1) << std::endl;    // 0 1
+
+    dynamic_connectivity dc(4);
+    dc.add_edge(0, 1);
+    dc.add_edge(1, 2);
+    dc.query(0, 2);
+    dc.remove_edge(0, 1);
+    dc.query(0, 2);
+    dc.add_edge(0, 2);
+    dc.query(0, 1);
+    dc.remove_edge(1, 3);
+    dc.remove_edge(0, 1);
+    dc.query(0, 3);
+    for (bool connected : dc.solve())
+        std::cout << connected << " ";
+    std::cout << std::endl;                                     // 1 0 1 0
+
+    compact_disjoint_set compact(10);
+    std::pair<int, int> edges[] = {{1, 2}, {2, 3}, {3, 1}, {5, 6}};
+    std::cout << compact.unite_many(edges, 4) << std::endl;     // 3
+    int vals[] = {1, 3, 6, 7};
+    int roots[4];
+    compact.find_many(vals, 4, roots);
+    std::cout << (roots[0] == roots[1]) << " "
+              << (roots[1] == roots[2]) << std::endl;           // 1 0
+    std::cout << compact.component_size(2) << " "
+              << compact.component_size(7) << std::endl;        // 3 1
+
     return 0;
 }
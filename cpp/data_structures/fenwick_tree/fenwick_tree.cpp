@@ -1,4 +1,10 @@
+#include <atomic>
 #include <fstream>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <utility>
 #include <vector>
 
 // Implementation of a Fenwick tree data structure.
@@ -7,42 +13,58 @@
 // efficient methods for calculation and manipulation of the prefix sums
 // of a table of values.
 //
+// The tree is templated on the type of the values, which must support
+// addition and subtraction; use a 64-bit type such as long long when the
+// sums may not fit in an int.
+//
 // For more information: http://en.wikipedia.org/wiki/Fenwick_tree
+//
+// Sample usage:
+//      std::vector<long long> weights = {3, 1, 4, 1, 5};
+//      fenwick_tree<long long> tree(weights.begin(), weights.end());
+//      tree.query(2, 4);       // 6
+//      tree.lower_bound(5);    // 3
+template <class T>
 class fenwick_tree {
 public:
     template <class ForwardIterator>
     explicit fenwick_tree(ForwardIterator begin, ForwardIterator end);
     explicit fenwick_tree(const int _size);
-    ~fenwick_tree();
 
-    int query(int id);
-    int query(int left, int right);
-    int find(int sum);
-    void update(int id, int to_add);
+    T query(int id) const;
+    T query(int left, int right) const;
+    int find(T sum) const;
+    int lower_bound(T prefix) const;
+    void update(int id, T to_add);
 
 private:
     int size;
-    int *tree;
+    std::vector<T> tree;
 };
 
 // Constructs a Fenwick tree from the range [begin, end). Each element
 // in the resulting tree will hold the cumulative frequency up to
 // that point.
 //
+// Rather than adding the elements one at a time, in O(N * logN) time,
+// each node pushes its partial sum to its parent once, in O(N) time.
+//
 // Args:
 //      begin: iterator pointing to the beginning of the range
 //      end: iterator pointing to the end of the range
+template <class T>
 template <class ForwardIterator>
-fenwick_tree::fenwick_tree(ForwardIterator begin, ForwardIterator end) {
-    size = 0;
-    ForwardIterator it = begin;
-    while (it++ != end)
-        ++size;
+fenwick_tree<T>::fenwick_tree(ForwardIterator begin, ForwardIterator end)
+        : tree(1, T()) {
+    while (begin != end)
+        tree.push_back(*begin++);
+    size = tree.size() - 1;
 
-    int i = 1;
-    tree = new int[size + 1];
-    while (begin != end) 
-        update(i++, *begin++); 
+    for (int i = 1; i <= size; ++i) {
+        int parent = i + (i & -i);
+        if (parent <= size)
+            tree[parent] += tree[i];
+    }
 }
 
 // Constructs a Fenwick tree of a specified size. Each element in the
@@ -51,22 +73,17 @@ fenwick_tree::fenwick_tree(ForwardIterator begin, ForwardIterator end) {
 //
 // Args:
 //      _size: size of the tree to be constructed
-fenwick_tree::fenwick_tree(const int _size) 
-        : size(_size) {
-    tree = new int[_size + 1];
-}
-
-// Frees all memory held by this data structure.
-fenwick_tree::~fenwick_tree() {
-    delete[] tree;
-}
+template <class T>
+fenwick_tree<T>::fenwick_tree(const int _size)
+        : size(_size), tree(_size + 1, T()) {}
 
 // Queries the cumulative frequency at id.
 //
 // Args:
 //      id: the index (1-based) to query
-int fenwick_tree::query(int id) {
-    int sum = 0;
+template <class T>
+T fenwick_tree<T>::query(int id) const {
+    T sum = T();
     while (id > 0) {
         sum += tree[id];
         // id & -id is the lowest set bit in id; by subtracting this
@@ -83,17 +100,18 @@ int fenwick_tree::query(int id) {
 // Args:
 //      left: leftmost index (1-based) of the interval to be queried
 //      right: rightmost index (1-based) of the interval to be queried
-int fenwick_tree::query(int left, int right) {
+template <class T>
+T fenwick_tree<T>::query(int left, int right) const {
     return query(right) - query(left - 1);
 }
 
-// Update the value at index id to be initial_value + to_add. Returns -1
-// if there is no index satisfying the requirements.
+// Update the value at index id to be initial_value + to_add.
 //
 // Args:
 //      id: index where the update should occur
 //      to_add: amount to add to the element at index id
-void fenwick_tree::update(int id, int to_add) {
+template <class T>
+void fenwick_tree<T>::update(int id, T to_add) {
     while (id <= size) {
         tree[id] += to_add;
         // id & -id is the lowest set bit in id; by adding this
@@ -103,28 +121,614 @@ void fenwick_tree::update(int id, int to_add) {
     }
 }
 
-// Find the index where the cumulative frequency is exactly equal
-// to sum.
+// Find the smallest index where the cumulative frequency is exactly
+// equal to sum. Returns -1 if there is no such index. Assumes that all
+// values are non-negative.
 //
 // Args:
 //      sum: the value to which the cumulative frequency must be 
 //          equal to
-int fenwick_tree::find(int sum) {
-    int bitmask;
-    for (bitmask = 1; bitmask < size; bitmask *= 2);
-
-    for (int i = 0; bitmask != 0; bitmask /= 2) {
-        if (i + bitmask <= size) {
-            if (sum >= tree[i + bitmask]) {
-                i += bitmask;
-                sum -= tree[i];
-                if (sum == 0)
-                    return i;
+template <class T>
+int fenwick_tree<T>::find(T sum) const {
+    int id = lower_bound(sum);
+    if (id <= size && query(id) == sum)
+        return id;
+
+    return -1;
+}
+
+// Find the smallest index (1-based) whose cumulative frequency is at
+// least prefix, in O(logN) time. Returns size + 1 if the total is
+// smaller than prefix. Assumes that all values are non-negative, so
+// that the cumulative frequencies are non-decreasing; with the values
+// as weights, lower_bound of a uniform sample in [1, total] picks each
+// index with probability proportional to its weight.
+//
+// Args:
+//      prefix: the cumulative frequency to search for
+template <class T>
+int fenwick_tree<T>::lower_bound(T prefix) const {
+    int bitmask = 1;
+    while (bitmask * 2 <= size)
+        bitmask *= 2;
+
+    // Descend from the root, keeping in id the largest index found so
+    // far whose cumulative frequency is below prefix.
+    int id = 0;
+    for (; bitmask != 0; bitmask /= 2) {
+        if (id + bitmask <= size && tree[id + bitmask] < prefix) {
+            id += bitmask;
+            prefix -= tree[id];
+        }
+    }
+
+    return id + 1;
+}
+
+// Implementation of a Fenwick tree supporting both range updates and
+// range queries.
+//
+// Adding value to every element in [left, right] changes the prefix sum
+// at id by value * (id - left + 1) for left <= id <= right, and by
+// value * (right - left + 1) past right. Both are linear in id, so the
+// prefix sum is kept as slope(id) * id - offset(id), where slope and
+// offset are the prefix sums of two ordinary Fenwick trees that each
+// receive two point updates per range update.
+//
+// Time complexity: O(logN) per update and query.
+//
+// Sample usage:
+//      range_fenwick_tree<long long> tree(10);
+//      tree.update(2, 5, 3);   // add 3 to elements 2..5
+//      tree.query(4, 8);       // 6
+template <class T>
+class range_fenwick_tree {
+public:
+    explicit range_fenwick_tree(const int _size)
+            : slope(_size), offset(_size) {}
+
+    T query(int id) const;
+    T query(int left, int right) const;
+    void update(int left, int right, T to_add);
+
+private:
+    fenwick_tree<T> slope;
+    fenwick_tree<T> offset;
+};
+
+// Queries the cumulative frequency at id.
+//
+// Args:
+//      id: the index (1-based) to query
+template <class T>
+T range_fenwick_tree<T>::query(int id) const {
+    return slope.query(id) * static_cast<T>(id) - offset.query(id);
+}
+
+// Queries the cumulative frequency in the range [left, right].
+//
+// Args:
+//      left: leftmost index (1-based) of the interval to be queried
+//      right: rightmost index (1-based) of the interval to be queried
+template <class T>
+T range_fenwick_tree<T>::query(int left, int right) const {
+    return query(right) - query(left - 1);
+}
+
+// Adds to_add to every element in the range [left, right].
+//
+// Args:
+//      left: leftmost index (1-based) of the interval to be updated
+//      right: rightmost index (1-based) of the interval to be updated
+//      to_add: amount to add to each element of the interval
+template <class T>
+void range_fenwick_tree<T>::update(int left, int right, T to_add) {
+    slope.update(left, to_add);
+    slope.update(right + 1, -to_add);
+    offset.update(left, to_add * static_cast<T>(left - 1));
+    offset.update(right + 1, -to_add * static_cast<T>(right));
+}
+
+// Implementation of a two-dimensional Fenwick tree, supporting point
+// updates and rectangle sums over a rows x cols grid.
+//
+// Each row of the grid is a Fenwick tree over the columns, and the rows
+// are combined as the nodes of a Fenwick tree over the rows. The nodes
+// are kept in one flat buffer, row after row, with the row stride
+// rounded up to a whole number of 64-byte cache lines, so that the
+// columns visited by an operation within one row stay on as few lines
+// as possible and rows do not share lines.
+//
+// Time complexity: O(logR * logC) per update and query.
+//
+// Sample usage:
+//      fenwick_tree_2d<long long> grid(4096, 4096);
+//      grid.update(10, 20, 1);
+//      grid.query(1, 1, 100, 100); // 1
+template <class T>
+class fenwick_tree_2d {
+public:
+    fenwick_tree_2d(const int _rows, const int _cols);
+
+    T query(int row, int col) const;
+    T query(int top, int left, int bottom, int right) const;
+    void update(int row, int col, T to_add);
+
+private:
+    int rows;
+    int cols;
+    size_t stride;
+    std::vector<T> tree;
+};
+
+// Constructs a two-dimensional Fenwick tree of a specified size, with
+// all elements initially 0.
+//
+// Args:
+//      _rows: number of rows of the grid
+//      _cols: number of columns of the grid
+template <class T>
+fenwick_tree_2d<T>::fenwick_tree_2d(const int _rows, const int _cols)
+        : rows(_rows), cols(_cols) {
+    const size_t per_line = sizeof(T) < 64 ? 64 / sizeof(T) : 1;
+    stride = (_cols + 1 + per_line - 1) / per_line * per_line;
+    tree.assign(stride * (_rows + 1), T());
+}
+
+// Queries the sum of the rectangle [1, row] x [1, col].
+//
+// Args:
+//      row: bottom row (1-based) of the rectangle
+//      col: rightmost column (1-based) of the rectangle
+template <class T>
+T fenwick_tree_2d<T>::query(int row, int col) const {
+    T sum = T();
+    for (int i = row; i > 0; i -= (i & -i)) {
+        const T* line = &tree[i * stride];
+        for (int j = col; j > 0; j -= (j & -j))
+            sum += line[j];
+    }
+
+    return sum;
+}
+
+// Queries the sum of the rectangle [top, bottom] x [left, right].
+//
+// Args:
+//      top: top row (1-based) of the rectangle
+//      left: leftmost column (1-based) of the rectangle
+//      bottom: bottom row (1-based) of the rectangle
+//      right: rightmost column (1-based) of the rectangle
+template <class T>
+T fenwick_tree_2d<T>::query(int top, int left, int bottom, int right) const {
+    return query(bottom, right) - query(top - 1, right)
+        - query(bottom, left - 1) + query(top - 1, left - 1);
+}
+
+// Adds to_add to the element at (row, col).
+//
+// Args:
+//      row: row (1-based) of the element
+//      col: column (1-based) of the element
+//      to_add: amount to add to the element
+template <class T>
+void fenwick_tree_2d<T>::update(int row, int col, T to_add) {
+    for (int i = row; i <= rows; i += (i & -i)) {
+        T* line = &tree[i * stride];
+        for (int j = col; j <= cols; j += (j & -j))
+            line[j] += to_add;
+    }
+}
+
+// Implementation of a Fenwick tree laid out in blocks of 16 counters, for
+// trees much larger than the cache.
+//
+// A query on a plain Fenwick tree visits O(logN) nodes scattered over the
+// whole array, so each is a separate cache miss once the tree no longer
+// fits in the cache. Here the tree has 16 children per node instead of
+// 2, and each node keeps the prefix sums of its children in one block of
+// 16 counters, which is one 64-byte cache line for 32-bit counters. The
+// leaves hold the prefix sums inside each block of 16 elements, and the
+// node above a block holds, for each of its children, the sum of the
+// children before it. A prefix query then reads one counter per level,
+// log16(N) in all, and only the lowest two levels are usually outside
+// the cache. An update adds to the counters after its position in one
+// block per level; the 16 adds of a block are branch-free and touch a
+// single line, so the compiler can turn them into a few vector adds
+// (two with AVX2, for 32-bit counters). Without those, updates are
+// slower than on a plain Fenwick tree. The extra memory is about 1/15
+// of the elements.
+//
+// query_many answers a batch of queries, prefetching the leaves of
+// queries further ahead in the batch so that their misses overlap.
+//
+// Time complexity: O(log16 N) per query, O(16 * log16 N) per update.
+//
+// Sample usage:
+//      std::vector<int> weights(1 << 24, 2);
+//      blocked_fenwick_tree<int> tree(weights.begin(), weights.end());
+//      int ids[] = {1, 10, 1 << 20};
+//      int sums[3];
+//      tree.query_many(ids, 3, sums);  // 2, 20, 2097152
+template <class T>
+class blocked_fenwick_tree {
+public:
+    template <class ForwardIterator>
+    explicit blocked_fenwick_tree(ForwardIterator begin, ForwardIterator end);
+    explicit blocked_fenwick_tree(const int _size);
+
+    T query(int id) const;
+    T query(int left, int right) const;
+    void query_many(const int* ids, size_t count, T* sums) const;
+    void update(int id, T to_add);
+
+private:
+    static const int branching = 16;
+    static const int branching_bits = 4;
+
+    // Number of queries query_many looks ahead when prefetching.
+    static const size_t prefetch_distance = 16;
+
+    void _layout();
+
+    int size;
+    // Position in tree of the first block of each level, leaves first.
+    std::vector<size_t> offset;
+    std::vector<T> tree;
+};
+
+// Constructs a blocked Fenwick tree from the range [begin, end), in O(N)
+// time.
+//
+// Args:
+//      begin: iterator pointing to the beginning of the range
+//      end: iterator pointing to the end of the range
+template <class T>
+template <class ForwardIterator>
+blocked_fenwick_tree<T>::blocked_fenwick_tree(ForwardIterator begin,
+                                              ForwardIterator end) {
+    std::vector<T> totals(begin, end);
+    size = totals.size();
+    _layout();
+
+    // totals holds the sums of the subtrees of one level; each level
+    // stores their prefix sums within each block, and passes the block
+    // sums up as the totals of the next level. Leaves include the
+    // element itself, inner levels only the children before it.
+    for (size_t level = 0; level < offset.size(); ++level) {
+        std::vector<T> next((totals.size() + branching - 1) / branching, T());
+        T running = T();
+        for (size_t i = 0; i < totals.size(); ++i) {
+            if (i % branching == 0)
+                running = T();
+            if (level != 0)
+                tree[offset[level] + i] = running;
+            running += totals[i];
+            if (level == 0)
+                tree[offset[level] + i] = running;
+            next[i / branching] += totals[i];
+        }
+        totals.swap(next);
+    }
+}
+
+// Constructs a blocked Fenwick tree of a specified size, with all
+// elements initially 0.
+//
+// Args:
+//      _size: size of the tree to be constructed
+template <class T>
+blocked_fenwick_tree<T>::blocked_fenwick_tree(const int _size)
+        : size(_size) {
+    _layout();
+}
+
+// Queries the cumulative frequency at id; an id past the end queries
+// the whole tree.
+//
+// Args:
+//      id: the index (1-based) to query
+template <class T>
+T blocked_fenwick_tree<T>::query(int id) const {
+    if (id > size)
+        id = size;
+    if (id <= 0)
+        return T();
+
+    // At level k, the counter of the subtree holding element id - 1 is
+    // at position (id - 1) >> (4 * k) of that level.
+    size_t position = id - 1;
+    T sum = T();
+    for (size_t level = 0; level < offset.size(); ++level) {
+        sum += tree[offset[level] + position];
+        position >>= branching_bits;
+    }
+
+    return sum;
+}
+
+// Queries the cumulative frequency in the range [left, right].
+//
+// Args:
+//      left: leftmost index (1-based) of the interval to be queried
+//      right: rightmost index (1-based) of the interval to be queried
+template <class T>
+T blocked_fenwick_tree<T>::query(int left, int right) const {
+    return query(right) - query(left - 1);
+}
+
+// Runs query for a batch of indices.
+//
+// Args:
+//      ids: the indices (1-based) to query
+//      count: number of entries in ids
+//      sums: output array of count entries; sums[i] receives
+//          query(ids[i])
+template <class T>
+void blocked_fenwick_tree<T>::query_many(const int* ids, size_t count,
+                                         T* sums) const {
+    for (size_t i = 0; i < count; ++i) {
+#ifdef __GNUC__
+        if (i + prefetch_distance < count) {
+            int ahead = ids[i + prefetch_distance] - 1;
+            if (ahead >= 0) {
+                __builtin_prefetch(&tree[offset[0] + ahead]);
+                if (offset.size() > 1)
+                    __builtin_prefetch(
+                        &tree[offset[1] + (ahead >> branching_bits)]);
             }
         }
+#endif
+        sums[i] = query(ids[i]);
+    }
+}
+
+// Update the value at index id to be initial_value + to_add. As with
+// fenwick_tree, an id past the end is ignored, and so is an id below 1.
+//
+// Args:
+//      id: index where the update should occur
+//      to_add: amount to add to the element at index id
+template <class T>
+void blocked_fenwick_tree<T>::update(int id, T to_add) {
+    if (id <= 0 || id > size)
+        return;
+
+    // The leaf prefix sums from id on include the element; at the inner
+    // levels, only the children after the one holding it do.
+    size_t position = id - 1;
+    size_t first = position % branching;
+    for (size_t level = 0; level < offset.size(); ++level) {
+        T* block = &tree[offset[level] + position - position % branching];
+        for (size_t i = 0; i < branching; ++i)
+            block[i] += i >= first ? to_add : T();
+
+        position >>= branching_bits;
+        first = position % branching + 1;
     }
+}
 
-    return -1;
+// Computes the offset of each level and allocates the tree. Each level
+// has one counter per block of the level below, rounded up to whole
+// blocks; the top level is a single block.
+template <class T>
+void blocked_fenwick_tree<T>::_layout() {
+    size_t entries = size;
+    size_t total = 0;
+    do {
+        offset.push_back(total);
+        total += (entries + branching - 1) / branching * branching;
+        entries = (entries + branching - 1) / branching;
+    } while (entries > 1);
+
+    tree.assign(total, T());
+}
+
+// Implementation of a Fenwick tree whose updates and queries may be
+// called concurrently from any number of threads, without locks.
+//
+// Every node is an atomic counter and an update is a fetch_add on each
+// of the O(logN) nodes it touches, so T must be an integral type.
+//
+// Consistency: for any index p <= id, exactly one of the nodes summed by
+// query(id) covers p, so every update is either entirely included in a
+// concurrent prefix query or entirely left out; a query never sees part
+// of an update. The result is the sum of all updates which happen before
+// the query, plus some subset of the concurrent ones. Queries are not
+// linearizable: the subset need not respect the order in which the
+// concurrent updates were made, and the two prefix queries behind a
+// range query may include different subsets.
+//
+// Sample usage:
+//      concurrent_fenwick_tree<long long> tree(1000);
+//      std::thread writer([&]() { tree.update(5, 1); });
+//      tree.query(10); // 0 or 1
+//      writer.join();
+template <class T>
+class concurrent_fenwick_tree {
+public:
+    explicit concurrent_fenwick_tree(const int _size);
+
+    T query(int id) const;
+    T query(int left, int right) const;
+    void update(int id, T to_add);
+
+private:
+    int size;
+    std::vector<std::atomic<T> > tree;
+};
+
+// Constructs a concurrent Fenwick tree of a specified size, with all
+// elements initially 0.
+//
+// Args:
+//      _size: size of the tree to be constructed
+template <class T>
+concurrent_fenwick_tree<T>::concurrent_fenwick_tree(const int _size)
+        : size(_size), tree(_size + 1) {
+    for (auto& node : tree)
+        node.store(T(), std::memory_order_relaxed);
+}
+
+// Queries the cumulative frequency at id.
+//
+// Args:
+//      id: the index (1-based) to query
+template <class T>
+T concurrent_fenwick_tree<T>::query(int id) const {
+    T sum = T();
+    for (; id > 0; id -= (id & -id))
+        sum += tree[id].load(std::memory_order_relaxed);
+
+    return sum;
+}
+
+// Queries the cumulative frequency in the range [left, right].
+//
+// Args:
+//      left: leftmost index (1-based) of the interval to be queried
+//      right: rightmost index (1-based) of the interval to be queried
+template <class T>
+T concurrent_fenwick_tree<T>::query(int left, int right) const {
+    return query(right) - query(left - 1);
+}
+
+// Update the value at index id to be initial_value + to_add.
+//
+// Args:
+//      id: index where the update should occur
+//      to_add: amount to add to the element at index id
+template <class T>
+void concurrent_fenwick_tree<T>::update(int id, T to_add) {
+    for (; id <= size; id += (id & -id))
+        tree[id].fetch_add(to_add, std::memory_order_relaxed);
+}
+
+// Implementation of a Fenwick tree for update-heavy concurrent loads.
+//
+// Updates do not touch the tree: each thread appends them to the log
+// of one of several shards, chosen by thread id, so that threads
+// rarely contend for a lock or a cache line. A query first merges the
+// pending updates of all the shards into the tree, then answers from
+// it. A log is also merged by the update that fills it to
+// merge_threshold entries, so the logs never hold more than
+// shards * merge_threshold updates however rarely the tree is queried.
+// Updates thus take O(logN) amortized time, with one lock on the tree
+// per merge_threshold updates, and a query takes O((P + 1) * logN)
+// time, where P is the number of updates still pending.
+//
+// Consistency: a query includes every update which happens before it,
+// and possibly some of the concurrent ones. As with
+// concurrent_fenwick_tree, each update is included entirely or not at
+// all, but queries are not linearizable. Queries are serialized with
+// each other.
+//
+// Sample usage:
+//      sharded_fenwick_tree<long long> tree(1000);
+//      tree.update(5, 1);
+//      tree.query(10); // 1
+template <class T>
+class sharded_fenwick_tree {
+public:
+    explicit sharded_fenwick_tree(const int _size): tree(_size) {}
+
+    T query(int id);
+    T query(int left, int right);
+    void update(int id, T to_add);
+
+private:
+    static const int shards = 16;
+    // Number of pending updates at which a shard is merged by update.
+    static const size_t merge_threshold = 4096;
+
+    // Updates not yet merged into the tree, padded to a cache line to
+    // avoid false sharing between shards.
+    struct alignas(64) shard {
+        std::mutex lock;
+        std::vector<std::pair<int, T> > pending;
+    };
+
+    void merge();
+
+    // Serializes the changes to tree.
+    std::mutex merger;
+    fenwick_tree<T> tree;
+    shard logs[shards];
+};
+
+// Queries the cumulative frequency at id.
+//
+// Args:
+//      id: the index (1-based) to query
+template <class T>
+T sharded_fenwick_tree<T>::query(int id) {
+    std::lock_guard<std::mutex> lock(merger);
+    merge();
+
+    return tree.query(id);
+}
+
+// Queries the cumulative frequency in the range [left, right]. Both
+// prefix queries see the same set of updates.
+//
+// Args:
+//      left: leftmost index (1-based) of the interval to be queried
+//      right: rightmost index (1-based) of the interval to be queried
+template <class T>
+T sharded_fenwick_tree<T>::query(int left, int right) {
+    std::lock_guard<std::mutex> lock(merger);
+    merge();
+
+    return tree.query(right) - tree.query(left - 1);
+}
+
+// Update the value at index id to be initial_value + to_add.
+//
+// Args:
+//      id: index where the update should occur
+//      to_add: amount to add to the element at index id
+template <class T>
+void sharded_fenwick_tree<T>::update(int id, T to_add) {
+    static thread_local size_t thread =
+        std::hash<std::thread::id>()(std::this_thread::get_id());
+
+    shard& s = logs[thread % shards];
+    {
+        std::lock_guard<std::mutex> lock(s.lock);
+        s.pending.push_back(std::make_pair(id, to_add));
+        if (s.pending.size() < merge_threshold)
+            return;
+    }
+
+    // merger is taken before the log is swapped out, in the same order
+    // as merge(), so that no query runs while the updates are in neither
+    // the log nor the tree. A query may have merged the log meanwhile.
+    std::lock_guard<std::mutex> merging(merger);
+    std::vector<std::pair<int, T> > batch;
+    {
+        std::lock_guard<std::mutex> lock(s.lock);
+        batch.swap(s.pending);
+    }
+
+    for (const auto& update : batch)
+        tree.update(update.first, update.second);
+}
+
+// Moves the pending updates of every shard into the tree. Must be
+// called with merger held.
+template <class T>
+void sharded_fenwick_tree<T>::merge() {
+    std::vector<std::pair<int, T> > batch;
+    for (int i = 0; i < shards; ++i) {
+        {
+            std::lock_guard<std::mutex> lock(logs[i].lock);
+            batch.swap(logs[i].pending);
+        }
+
+        for (const auto& update : batch)
+            tree.update(update.first, update.second);
+        batch.clear();
+    }
 }
 
 int main()
@@ -135,19 +739,19 @@ int main()
     int N, M;
     fin >> N >> M;
 
-    fenwick_tree tree(N);
-    for (int i = 0; i < N; ++i) {
-        int x;
-        fin >> x;
-        tree.update(i + 1, x);
-    }
+    std::vector<long long> values(N);
+    for (int i = 0; i < N; ++i)
+        fin >> values[i];
+
+    fenwick_tree<long long> tree(values.begin(), values.end());
 
     for (int i = 0; i < M; ++i) {
         int op;
         fin >> op;
 
         if (op == 0) {
-            int id, val;
+            int id;
+            long long val;
             fin >> id >> val;
             tree.update(id, val);
         } else if (op == 1) {
@@ -155,11 +759,62 @@ int main()
             fin >> l >> r;
             fout << tree.query(l, r) << "\n";
         } else {
-            int sum;
+            long long sum;
             fin >> sum;
             fout << tree.find(sum) << "\n";
         }
     }
 
+    // The variants below print their results to stdout; the expected
+    // values are in the comments.
+    std::vector<long long> weights_small = {3, 1, 4, 1, 5};
+    fenwick_tree<long long> small(weights_small.begin(), weights_small.end());
+    std::cout << small.query(2, 4) << " "
+              << small.lower_bound(5) << " "
+              << small.lower_bound(15) << std::endl;            // 6 3 6
+
+    range_fenwick_tree<long long> ranges(10);
+    ranges.update(2, 5, 3);
+    ranges.update(4, 10, 1);
+    std::cout << ranges.query(4, 8) << " "
+              << ranges.query(1) << std::endl;                  // 11 0
+
+    fenwick_tree_2d<long long> grid(100, 100);
+    grid.update(10, 20, 1);
+    grid.update(50, 50, 2);
+    grid.update(100, 100, 4);
+    std::cout << grid.query(1, 1, 50, 50) << " "
+              << grid.query(11, 1, 100, 100) << " "
+              << grid.query(10, 20) << std::endl;               // 3 6 1
+
+    std::vector<int> weights(1000, 2);
+    blocked_fenwick_tree<int> blocked(weights.begin(), weights.end());
+    blocked.update(17, 5);
+    blocked.update(0, 100);
+    blocked.update(1001, 100);
+    int ids[] = {1, 17, 1000};
+    int sums[3];
+    blocked.query_many(ids, 3, sums);
+    std::cout << sums[0] << " " << sums[1] << " " << sums[2] << " "
+              << blocked.query(16, 17) << " "
+              << blocked.query(2000) << std::endl;      // 2 39 2005 9 2005
+
+    concurrent_fenwick_tree<long long> concurrent(1000);
+    sharded_fenwick_tree<long long> sharded(1000);
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; ++t)
+        writers.push_back(std::thread([&concurrent, &sharded]() {
+            for (int i = 0; i < 10000; ++i) {
+                concurrent.update(i % 1000 + 1, 1);
+                sharded.update(i % 1000 + 1, 1);
+            }
+        }));
+    for (auto& writer : writers)
+        writer.join();
+    std::cout << concurrent.query(1000) << " "
+              << concurrent.query(1, 10) << " "
+              << sharded.query(1000) << " "
+              << sharded.query(1, 10) << std::endl;     // 40000 400 40000 400
+
     return 0;
 }
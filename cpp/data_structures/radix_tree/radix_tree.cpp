@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Implementation of a radix tree (path-compressed trie).
+//
+// A radix tree is a trie in which every node that is the only child of
+// its parent and does not end a word is merged into its parent, so the
+// edges are labeled with strings instead of single characters. Keys
+// with long shared prefixes, such as URLs or file paths, then need one
+// node per branching point rather than one node per character.
+//
+// Queries and updates take O(length) time, like in a Trie.
+//
+// For more information: https://en.wikipedia.org/wiki/Radix_tree
+//
+// Sample usage:
+//      radix_tree t;
+//      t.insert("/usr/bin");
+//      t.insert("/usr/lib");
+//      t.count("/usr/bin"); // 1
+//      t.erase("/usr/bin");
+class radix_tree {
+public:
+    radix_tree(): root(new node()), words(0) {}
+
+    void insert(const std::string& word);
+    int count(const std::string& word) const;
+    bool erase(const std::string& word);
+
+    size_t size() const {
+        return words;
+    }
+
+private:
+    struct node {
+        node(): word_end(false) {}
+
+        // Label of the edge leading into this node.
+        std::string label;
+        bool word_end;
+        // Children, sorted by the first character of their label.
+        std::vector<std::unique_ptr<node>> children;
+    };
+
+    static std::vector<std::unique_ptr<node>>::iterator find_child(
+            node* n, char c);
+    bool erase(node* n, const std::string& word, size_t pos);
+
+    std::unique_ptr<node> root;
+    size_t words;
+};
+
+// Returns the child of n whose label starts with c, or the position
+// where such a child should be inserted.
+std::vector<std::unique_ptr<radix_tree::node>>::iterator
+radix_tree::find_child(node* n, char c) {
+    return std::lower_bound(n->children.begin(), n->children.end(), c,
+            [](const std::unique_ptr<node>& child, char value) {
+        return child->label[0] < value;
+    });
+}
+
+// Insert a word into the tree.
+//
+// Args:
+//      word: string to be inserted
+void radix_tree::insert(const std::string& word) {
+    node* n = root.get();
+    size_t pos = 0;
+
+    while (pos < word.size()) {
+        auto it = find_child(n, word[pos]);
+        if (it == n->children.end() || (*it)->label[0] != word[pos]) {
+            std::unique_ptr<node> leaf(new node());
+            leaf->label = word.substr(pos);
+            leaf->word_end = true;
+            n->children.insert(it, std::move(leaf));
+            ++words;
+            return;
+        }
+
+        node* child = it->get();
+        size_t common = 0;
+        while (common < child->label.size() && pos + common < word.size() &&
+                child->label[common] == word[pos + common])
+            ++common;
+
+        if (common < child->label.size()) {
+            // The word diverges inside the label: split the edge.
+            std::unique_ptr<node> middle(new node());
+            middle->label = child->label.substr(0, common);
+            child->label.erase(0, common);
+            middle->children.push_back(std::move(*it));
+            *it = std::move(middle);
+            child = it->get();
+        }
+
+        n = child;
+        pos += common;
+    }
+
+    if (!n->word_end) {
+        n->word_end = true;
+        ++words;
+    }
+}
+
+// Count the number of appearances of the word.
+// Will return 1 if the tree contains word and 0 otherwise.
+//
+// Args:
+//      word: string to search for
+int radix_tree::count(const std::string& word) const {
+    node* n = root.get();
+    size_t pos = 0;
+
+    while (pos < word.size()) {
+        auto it = find_child(n, word[pos]);
+        if (it == n->children.end() || (*it)->label[0] != word[pos])
+            return 0;
+
+        const std::string& label = (*it)->label;
+        if (word.compare(pos, label.size(), label) != 0)
+            return 0;
+
+        n = it->get();
+        pos += label.size();
+    }
+
+    return n->word_end;
+}
+
+// Remove a word from the tree, merging the nodes that no longer branch.
+//
+// Args:
+//      word: string to be removed
+//
+// Returns: true if the word was present
+bool radix_tree::erase(const std::string& word) {
+    if (word.empty()) {
+        if (!root->word_end)
+            return false;
+        root->word_end = false;
+        --words;
+        return true;
+    }
+
+    return erase(root.get(), word, 0);
+}
+
+bool radix_tree::erase(node* n, const std::string& word, size_t pos) {
+    auto it = find_child(n, word[pos]);
+    if (it == n->children.end() || (*it)->label[0] != word[pos])
+        return false;
+
+    node* child = it->get();
+    const std::string& label = child->label;
+    if (word.compare(pos, label.size(), label) != 0)
+        return false;
+
+    pos += label.size();
+    if (pos == word.size()) {
+        if (!child->word_end)
+            return false;
+        child->word_end = false;
+        --words;
+    } else if (!erase(child, word, pos)) {
+        return false;
+    }
+
+    if (!child->word_end) {
+        if (child->children.empty()) {
+            n->children.erase(it);
+        } else if (child->children.size() == 1) {
+            // Merge the only grandchild into the child.
+            std::unique_ptr<node> grandchild = std::move(child->children[0]);
+            grandchild->label = child->label + grandchild->label;
+            *it = std::move(grandchild);
+        }
+    }
+
+    return true;
+}
+
+int main()
+{
+    radix_tree t;
+    t.insert("banana");
+    t.insert("band");
+
+    std::cout << t.count("ban") << std::endl;
+    std::cout << t.count("band") << std::endl;
+
+    t.erase("band");
+    std::cout << t.count("band") << std::endl;
+    std::cout << t.count("banana") << std::endl;
+    std::cout << t.size() << std::endl;
+
+    return 0;
+}
@@ -1,9 +1,20 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <queue>
 #include <string>
 #include <vector>
 #include <unordered_map>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 // Implementation of a Trie data structure.
 //
 // A trie is an ordered data structure that is used to store
@@ -17,38 +28,71 @@
 class Trie {
 public:
     Trie(): 
-        word_end(false)
+        word_end(false), score(0),
+        best_score(std::numeric_limits<long long>::min())
     {};
 
     void insert(std::string word);
+    void insert(std::string word, long long _score);
     int count(std::string word);
 
     template <class ForwardIterator>
     void insert(ForwardIterator begin, ForwardIterator end);
     template <class ForwardIterator>
+    void insert(ForwardIterator begin, ForwardIterator end, long long _score);
+    template <class ForwardIterator>
     int count(ForwardIterator begin, ForwardIterator end);
 
     std::vector<std::string> words();
 
+    template <class Callback>
+    void for_each_with_prefix(const std::string& prefix, Callback callback);
+    std::vector<std::pair<std::string, long long>> top_k(
+            const std::string& prefix, size_t k);
+
 private:
-    void traversal(std::string current, std::vector<std::string>& words);
+    friend class double_array_trie;
+
+    template <class Callback>
+    void traversal(std::string& current, Callback& callback);
+    Trie* find(const std::string& prefix);
 
     bool word_end;
+    // Score of the word ending here, and the highest score of a word
+    // in this subtree.
+    long long score;
+    long long best_score;
     std::unordered_map<char, std::unique_ptr<Trie>> children; 
 };
 
-void Trie::traversal(std::string current, std::vector<std::string>& words) {
+// Calls callback(word) for every word in this subtree, where current
+// holds the path from the root and is restored before returning.
+template <class Callback>
+void Trie::traversal(std::string& current, Callback& callback) {
     if (word_end) {
-        words.push_back(current);
+        callback(static_cast<const std::string&>(current));
     }
 
     for (auto& kv : children) {
         current.push_back(kv.first);
-        kv.second->traversal(current, words);
+        kv.second->traversal(current, callback);
         current.pop_back();
     }
 }
 
+// Returns the node reached by following prefix, or nullptr.
+Trie* Trie::find(const std::string& prefix) {
+    Trie* node = this;
+    for (char c : prefix) {
+        auto it = node->children.find(c);
+        if (it == node->children.end())
+            return nullptr;
+        node = it->second.get();
+    }
+
+    return node;
+}
+
 // Insert a word into the Trie
 //
 // Args:
@@ -57,6 +101,17 @@ void Trie::insert(std::string word) {
     insert(word.begin(), word.end());
 }
 
+// Insert a word into the Trie, or update its score if it is already
+// present. Scores rank the results of top_k; words inserted without a
+// score have score 0.
+//
+// Args:
+//      word: string to be inserted
+//      _score: weight of the word
+void Trie::insert(std::string word, long long _score) {
+    insert(word.begin(), word.end(), _score);
+}
+
 // Count the number of appearances of the word.
 // Will return 1 if the trie contains word and 0 otherwise.
 //
@@ -70,6 +125,7 @@ template <class ForwardIterator>
 void Trie::insert(ForwardIterator begin, ForwardIterator end) {
     if (begin == end) {
         word_end = true;
+        best_score = std::max(best_score, score);
         return;
     }
 
@@ -77,6 +133,27 @@ void Trie::insert(ForwardIterator begin, ForwardIterator end) {
         children[*begin] = std::unique_ptr<Trie>(new Trie());
     }
     children[*begin]->insert(std::next(begin), end);
+    best_score = std::max(best_score, children[*begin]->best_score);
+}
+
+template <class ForwardIterator>
+void Trie::insert(ForwardIterator begin, ForwardIterator end,
+                  long long _score) {
+    if (begin == end) {
+        word_end = true;
+        score = _score;
+    } else {
+        if (children.find(*begin) == children.end()) {
+            children[*begin] = std::unique_ptr<Trie>(new Trie());
+        }
+        children[*begin]->insert(std::next(begin), end, _score);
+    }
+
+    // The score of the word may have decreased, so the maximum over
+    // the subtree is recomputed rather than updated.
+    best_score = word_end ? score : std::numeric_limits<long long>::min();
+    for (auto& kv : children)
+        best_score = std::max(best_score, kv.second->best_score);
 }
 
 template <class ForwardIterator>
@@ -92,7 +169,593 @@ int Trie::count(ForwardIterator begin, ForwardIterator end) {
 // Return a vector of the words stored in the trie.
 std::vector<std::string> Trie::words() {
     std::vector<std::string> result;
-    traversal("", result);
+    for_each_with_prefix("", [&](const std::string& word) {
+        result.push_back(word);
+    });
+
+    return result;
+}
+
+// Call callback(word) for every word in the trie starting with prefix.
+// The words are built in a single buffer, so the callback receives a
+// reference that is only valid for the duration of the call.
+//
+// Args:
+//      prefix: prefix of the words to enumerate
+//      callback: function taking a const std::string&
+template <class Callback>
+void Trie::for_each_with_prefix(const std::string& prefix,
+                                Callback callback) {
+    Trie* node = find(prefix);
+    if (node == nullptr)
+        return;
+
+    std::string current = prefix;
+    node->traversal(current, callback);
+}
+
+// Return the (at most) k words with the highest scores among those
+// starting with prefix, in decreasing order of score.
+//
+// Subtrees are explored best-first, ordered by the highest score they
+// contain, so only the subtrees that can still produce one of the top
+// k words are expanded.
+//
+// Args:
+//      prefix: prefix of the words to complete
+//      k: number of completions to return
+std::vector<std::pair<std::string, long long>> Trie::top_k(
+        const std::string& prefix, size_t k) {
+    std::vector<std::pair<std::string, long long>> result;
+
+    Trie* start = find(prefix);
+    if (start == nullptr || k == 0)
+        return result;
+
+    // Expanded nodes, with the index of their parent and the character
+    // leading to them, so that words are only spelled out for results.
+    struct entry {
+        Trie* node;
+        int parent;
+        char c;
+    };
+    std::vector<entry> entries;
+    entries.push_back(entry{start, -1, 0});
+
+    // (priority, entry index, whether the entry stands for its word or
+    // for its whole subtree)
+    typedef std::pair<long long, std::pair<int, bool>> item;
+    std::priority_queue<item> q;
+    q.push(item(start->best_score, std::make_pair(0, false)));
+
+    while (!q.empty() && result.size() < k) {
+        item top = q.top();
+        q.pop();
+
+        int id = top.second.first;
+        if (top.second.second) {
+            std::string word;
+            for (int e = id; entries[e].parent != -1; e = entries[e].parent)
+                word.push_back(entries[e].c);
+            std::reverse(word.begin(), word.end());
+            result.push_back(std::make_pair(prefix + word, top.first));
+            continue;
+        }
+
+        Trie* node = entries[id].node;
+        if (node->word_end)
+            q.push(item(node->score, std::make_pair(id, true)));
+        for (auto& kv : node->children) {
+            entries.push_back(entry{kv.second.get(), id, kv.first});
+            q.push(item(kv.second->best_score,
+                        std::make_pair(static_cast<int>(entries.size()) - 1,
+                                       false)));
+        }
+    }
+
+    return result;
+}
+
+// Implementation of a Trie with flat, arena-allocated storage.
+//
+// Offers the same insert and count operations as Trie, but instead of a
+// heap-allocated node with its own hash map per character, every node is
+// an 8-byte record in a single array, and nodes refer to each other
+// through 32-bit indices. The children of a node are kept as a sorted
+// array of (label, index) pairs in a shared edge arena; a node that
+// outgrows dense_threshold children switches to a 256-entry table
+// indexed directly by the next character.
+//
+// Sample usage:
+//      flat_trie t;
+//      t.insert("banana");
+//      t.count("banana"); // 1
+class flat_trie {
+public:
+    flat_trie(): nodes(1) {}
+
+    void insert(const std::string& word) {
+        insert(word.begin(), word.end());
+    }
+
+    int count(const std::string& word) const {
+        return count(word.begin(), word.end());
+    }
+
+    template <class ForwardIterator>
+    void insert(ForwardIterator begin, ForwardIterator end);
+    template <class ForwardIterator>
+    int count(ForwardIterator begin, ForwardIterator end) const;
+
+    size_t memory_usage() const;
+
+private:
+    // Index 0 is the root, which is never a child, so it doubles as the
+    // "no such child" marker.
+    static const uint32_t none = 0;
+    static const int dense_threshold = 16;
+    static const int max_capacity_log = 4;
+
+    struct node {
+        node(): edges(0), size(0), capacity_log(0), dense(false),
+                word_end(false) {}
+
+        // Offset of the children in labels/targets, or in dense_edges
+        // for dense nodes.
+        uint32_t edges;
+        uint16_t size;
+        uint8_t capacity_log;
+        bool dense : 1;
+        bool word_end : 1;
+    };
+
+    uint32_t child(uint32_t id, unsigned char c) const;
+    uint32_t add_child(uint32_t id, unsigned char c);
+    uint32_t allocate_edges(int capacity_log);
+
+    std::vector<node> nodes;
+
+    // Sorted small child arrays, allocated in blocks of 2^k entries.
+    std::vector<unsigned char> labels;
+    std::vector<uint32_t> targets;
+    std::vector<uint32_t> free_edges[max_capacity_log + 1];
+
+    // 256-entry child tables of dense nodes.
+    std::vector<uint32_t> dense_edges;
+};
+
+const uint32_t flat_trie::none;
+
+// Returns the child of node id reached through c, or none.
+uint32_t flat_trie::child(uint32_t id, unsigned char c) const {
+    const node& n = nodes[id];
+    if (n.dense)
+        return dense_edges[n.edges + c];
+
+    for (uint32_t i = n.edges; i < n.edges + n.size; ++i) {
+        if (labels[i] == c)
+            return targets[i];
+        if (labels[i] > c)
+            break;
+    }
+
+    return none;
+}
+
+// Returns the offset of a free block of 2^capacity_log edges.
+uint32_t flat_trie::allocate_edges(int capacity_log) {
+    if (!free_edges[capacity_log].empty()) {
+        uint32_t offset = free_edges[capacity_log].back();
+        free_edges[capacity_log].pop_back();
+        return offset;
+    }
+
+    uint32_t offset = labels.size();
+    labels.resize(offset + (1u << capacity_log));
+    targets.resize(offset + (1u << capacity_log));
+
+    return offset;
+}
+
+// Creates a new node as the child of node id through c, and returns its
+// index.
+uint32_t flat_trie::add_child(uint32_t id, unsigned char c) {
+    uint32_t created = nodes.size();
+    nodes.push_back(node());
+
+    node& n = nodes[id];
+    if (n.dense) {
+        dense_edges[n.edges + c] = created;
+        return created;
+    }
+
+    if (n.size == dense_threshold) {
+        // Too many children for a linear scan: move them to a table.
+        uint32_t offset = dense_edges.size();
+        dense_edges.resize(offset + 256, none);
+        for (uint32_t i = n.edges; i < n.edges + n.size; ++i)
+            dense_edges[offset + labels[i]] = targets[i];
+        dense_edges[offset + c] = created;
+
+        free_edges[n.capacity_log].push_back(n.edges);
+        n.edges = offset;
+        n.dense = true;
+        ++n.size;
+        return created;
+    }
+
+    if (n.size == 0 || n.size == (1u << n.capacity_log)) {
+        // The current block is full: move to one twice as large.
+        int capacity_log = n.size == 0 ? 0 : n.capacity_log + 1;
+        uint32_t offset = allocate_edges(capacity_log);
+        std::copy(labels.begin() + n.edges, labels.begin() + n.edges + n.size,
+                  labels.begin() + offset);
+        std::copy(targets.begin() + n.edges,
+                  targets.begin() + n.edges + n.size,
+                  targets.begin() + offset);
+
+        if (n.size != 0)
+            free_edges[n.capacity_log].push_back(n.edges);
+        n.edges = offset;
+        n.capacity_log = capacity_log;
+    }
+
+    // Insert c while keeping the labels sorted.
+    uint32_t pos = n.edges + n.size;
+    while (pos > n.edges && labels[pos - 1] > c) {
+        labels[pos] = labels[pos - 1];
+        targets[pos] = targets[pos - 1];
+        --pos;
+    }
+    labels[pos] = c;
+    targets[pos] = created;
+    ++n.size;
+
+    return created;
+}
+
+template <class ForwardIterator>
+void flat_trie::insert(ForwardIterator begin, ForwardIterator end) {
+    uint32_t id = 0;
+    for (; begin != end; ++begin) {
+        uint32_t next = child(id, *begin);
+        id = next != none ? next : add_child(id, *begin);
+    }
+
+    nodes[id].word_end = true;
+}
+
+template <class ForwardIterator>
+int flat_trie::count(ForwardIterator begin, ForwardIterator end) const {
+    uint32_t id = 0;
+    for (; begin != end; ++begin) {
+        id = child(id, *begin);
+        if (id == none)
+            return 0;
+    }
+
+    return nodes[id].word_end;
+}
+
+// Returns the number of bytes allocated by the trie.
+size_t flat_trie::memory_usage() const {
+    return nodes.capacity() * sizeof(node) +
+        labels.capacity() * sizeof(unsigned char) +
+        targets.capacity() * sizeof(uint32_t) +
+        dense_edges.capacity() * sizeof(uint32_t);
+}
+
+// Implementation of a read-only double-array trie.
+//
+// A double-array trie encodes the transitions of a trie in two integer
+// arrays: the child of state s through code c is t = base[s] + c, and
+// the transition exists iff check[t] == s. Code 0 marks the end of a
+// word, and the byte c is encoded as c + 1.
+//
+// A built Trie is compiled once into a binary image holding a small
+// header followed by the two arrays; load() maps the image into memory
+// and serves lookups from the mapping directly, so startup costs no
+// parsing and the pages are shared by every process that maps the same
+// file. The image uses the byte order of the machine that wrote it.
+//
+// For more information: https://linux.thai.net/~thep/datrie/datrie.html
+//
+// Sample usage:
+//      double_array_trie::compile(trie, "words.dat");
+//      double_array_trie dat;
+//      dat.load("words.dat");
+//      dat.count("banana");
+class double_array_trie {
+public:
+    static const uint32_t version = 1;
+
+    double_array_trie(): base(nullptr), check(nullptr), size(0),
+                         mapping(nullptr), mapping_size(0) {}
+    ~double_array_trie();
+
+    double_array_trie(const double_array_trie&) = delete;
+    double_array_trie& operator=(const double_array_trie&) = delete;
+
+    static bool compile(const Trie& trie, const std::string& path);
+    bool load(const std::string& path);
+
+    int count(const std::string& word) const;
+    bool has_prefix(const std::string& prefix) const;
+    std::vector<size_t> prefixes_of(const std::string& text) const;
+
+private:
+    struct header {
+        char magic[8];
+        uint32_t version;
+        uint32_t size;
+    };
+
+    static const char magic[8];
+
+    // Follows the transition from state through code; returns -1 if
+    // there is none.
+    int32_t next(int32_t state, int code) const {
+        int64_t t = static_cast<int64_t>(base[state]) + code;
+        if (t < 0 || t >= size || check[t] != state)
+            return -1;
+        return t;
+    }
+
+    void unload();
+
+    const int32_t* base;
+    const int32_t* check;
+    uint32_t size;
+
+    void* mapping;
+    size_t mapping_size;
+};
+
+const uint32_t double_array_trie::version;
+const char double_array_trie::magic[8] = { 'D', 'A', 'T', 'R', 'I', 'E',
+                                           '\0', '\0' };
+
+double_array_trie::~double_array_trie() {
+    unload();
+}
+
+void double_array_trie::unload() {
+    if (mapping != nullptr)
+        munmap(mapping, mapping_size);
+
+    mapping = nullptr;
+    mapping_size = 0;
+    base = check = nullptr;
+    size = 0;
+}
+
+// Converts trie into a double-array trie and writes its image to path.
+// States are placed in breadth-first order, each at the first base for
+// which all of its transitions land on free cells.
+//
+// Args:
+//      trie: trie to compile
+//      path: file to write the image to
+//
+// Returns: false if the image could not be written
+bool double_array_trie::compile(const Trie& trie, const std::string& path) {
+    // The root occupies cell 0. Free cells are kept in a linked list in
+    // increasing order (next_free, prev_free), so that placing a state
+    // only visits cells that can hold its first transition; -1 stands
+    // for the end of the array, past which every cell is free.
+    std::vector<int32_t> base(1, 0), check(1, -1);
+    std::vector<int32_t> next_free(1, -1), prev_free(1, -1);
+    int32_t last_free = -1;
+
+    // Free cell at which the search for a base starts. Cells before it
+    // are too fragmented to be worth scanning, but remain free for
+    // transitions other than the first one of a state.
+    int32_t start = -1;
+
+    // Grows the arrays to at least n cells, appending the new cells to
+    // the free list.
+    auto extend = [&](size_t n) {
+        for (int32_t t = base.size(); static_cast<size_t>(t) < n; ++t) {
+            base.push_back(0);
+            check.push_back(-1);
+            next_free.push_back(-1);
+            prev_free.push_back(last_free);
+            if (last_free >= 0)
+                next_free[last_free] = t;
+            if (start < 0)
+                start = t;
+            last_free = t;
+        }
+    };
+
+    auto take = [&](int32_t t) {
+        if (t == start)
+            start = next_free[t];
+        if (prev_free[t] >= 0)
+            next_free[prev_free[t]] = next_free[t];
+        if (next_free[t] >= 0)
+            prev_free[next_free[t]] = prev_free[t];
+        else
+            last_free = prev_free[t];
+    };
+
+    std::queue<std::pair<const Trie*, int32_t> > q;
+    q.push(std::make_pair(&trie, 0));
+
+    std::vector<std::pair<int, const Trie*> > children;
+    while (!q.empty()) {
+        const Trie* node = q.front().first;
+        int32_t state = q.front().second;
+        q.pop();
+
+        children.clear();
+        if (node->word_end)
+            children.push_back(std::make_pair(0, nullptr));
+        for (const auto& kv : node->children)
+            children.push_back(std::make_pair(
+                    static_cast<unsigned char>(kv.first) + 1,
+                    kv.second.get()));
+        if (children.empty())
+            continue;
+        std::sort(children.begin(), children.end());
+
+        // Find the first base at which every transition is free.
+        const int lowest = children[0].first;
+        extend(lowest + 1);
+
+        int32_t b = 0, tries = 0;
+        const int32_t scan_start = start;
+        for (int32_t pos = start; ; pos = next_free[pos], ++tries) {
+            if (pos < 0) {
+                // Out of free cells: place the state at the end.
+                pos = base.size();
+                extend(pos + 1);
+            }
+            if (pos < lowest)
+                continue;
+
+            b = pos - lowest;
+            extend(b + children.back().first + 1);
+
+            bool fits = true;
+            for (const auto& child : children)
+                if (check[b + child.first] != -1) {
+                    fits = false;
+                    break;
+                }
+            if (fits) {
+                // Skip ahead once the scanned cells are mostly taken.
+                if (tries > 256 || 20 * (tries + 1) < pos - scan_start + 1)
+                    start = pos;
+                break;
+            }
+        }
+
+        base[state] = b;
+        for (const auto& child : children) {
+            int32_t t = b + child.first;
+            take(t);
+            check[t] = state;
+            if (child.second != nullptr)
+                q.push(std::make_pair(child.second, t));
+        }
+    }
+
+    header h;
+    std::memcpy(h.magic, magic, sizeof(magic));
+    h.version = version;
+    h.size = base.size();
+
+    std::ofstream fout(path, std::ios::binary);
+    fout.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    fout.write(reinterpret_cast<const char*>(base.data()),
+               base.size() * sizeof(int32_t));
+    fout.write(reinterpret_cast<const char*>(check.data()),
+               check.size() * sizeof(int32_t));
+
+    return static_cast<bool>(fout);
+}
+
+// Maps the image at path, replacing any previously loaded image.
+//
+// Args:
+//      path: file written by compile
+//
+// Returns: false if the file cannot be mapped or is not a valid image
+bool double_array_trie::load(const std::string& path) {
+    unload();
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(header)) {
+        close(fd);
+        return false;
+    }
+
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+
+    mapping = data;
+    mapping_size = st.st_size;
+
+    const header* h = static_cast<const header*>(data);
+    if (std::memcmp(h->magic, magic, sizeof(magic)) != 0 ||
+            h->version != version ||
+            mapping_size != sizeof(header) + 2 * sizeof(int32_t) * h->size) {
+        unload();
+        return false;
+    }
+
+    size = h->size;
+    base = reinterpret_cast<const int32_t*>(h + 1);
+    check = base + size;
+
+    return true;
+}
+
+// Returns 1 if the image contains word and 0 otherwise.
+int double_array_trie::count(const std::string& word) const {
+    if (size == 0)
+        return 0;
+
+    int32_t state = 0;
+    for (unsigned char c : word) {
+        state = next(state, c + 1);
+        if (state < 0)
+            return 0;
+    }
+
+    return next(state, 0) >= 0;
+}
+
+// Returns whether some word in the image starts with prefix.
+bool double_array_trie::has_prefix(const std::string& prefix) const {
+    if (size == 0)
+        return false;
+
+    // Every state other than the root has a transition, but the root of
+    // an empty trie has none, and then not even "" is a prefix.
+    if (prefix.empty()) {
+        for (int code = 0; code <= 256; ++code)
+            if (next(0, code) >= 0)
+                return true;
+        return false;
+    }
+
+    int32_t state = 0;
+    for (unsigned char c : prefix) {
+        state = next(state, c + 1);
+        if (state < 0)
+            return false;
+    }
+
+    return true;
+}
+
+// Returns the lengths, in increasing order, of the words in the image
+// that are prefixes of text.
+std::vector<size_t> double_array_trie::prefixes_of(
+        const std::string& text) const {
+    std::vector<size_t> result;
+    if (size == 0)
+        return result;
+
+    int32_t state = 0;
+    for (size_t i = 0; ; ++i) {
+        if (next(state, 0) >= 0)
+            result.push_back(i);
+        if (i == text.size())
+            break;
+
+        state = next(state, static_cast<unsigned char>(text[i]) + 1);
+        if (state < 0)
+            break;
+    }
 
     return result;
 }
@@ -110,5 +773,29 @@ int main()
     for (auto s : words)
         std::cout << s << std::endl;
 
+    flat_trie ft;
+    ft.insert("banana");
+    ft.insert("band");
+
+    std::cout << ft.count("ban") << std::endl;
+    std::cout << ft.count("band") << std::endl;
+
+    t.insert("bandana", 5);
+    t.insert("bank", 3);
+    for (const auto& kv : t.top_k("ban", 2))
+        std::cout << kv.first << " " << kv.second << std::endl;
+
+    double_array_trie dat;
+    if (double_array_trie::compile(t, "trie.dat") && dat.load("trie.dat")) {
+        std::cout << dat.count("ban") << std::endl;
+        std::cout << dat.count("band") << std::endl;
+        std::cout << dat.has_prefix("ban") << std::endl;
+        std::cout << dat.has_prefix("") << std::endl;
+    }
+
+    Trie empty;
+    if (double_array_trie::compile(empty, "empty.dat") && dat.load("empty.dat"))
+        std::cout << dat.has_prefix("") << std::endl;
+
     return 0;
 }
\ No newline at end of file